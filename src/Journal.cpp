@@ -0,0 +1,215 @@
+#include "Journal.h"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace ClassProject {
+
+static const char JOURNAL_MAGIC[4] = {'V', 'D', 'S', 'J'};
+static const char JOURNAL_VERSION = 2;
+
+size_t operandCount(Operation op) {
+  switch (op) {
+    case Operation::CreateVar:
+      return 0;
+    case Operation::Neg:
+      return 1;
+    case Operation::Ite:
+      return 3;
+    default:
+      return 2;
+  }
+}
+
+JournalWriter::JournalWriter(const std::string& path)
+    : out(path, std::ios::binary | std::ios::trunc) {
+  if (!out.is_open()) {
+    throw std::runtime_error("Could not create journal: " + path);
+  }
+  out.write(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+  out.put(JOURNAL_VERSION);
+}
+
+void JournalWriter::writeVarint(uint64_t value) {
+  while (value >= 0x80) {
+    out.put(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.put(static_cast<char>(value));
+}
+
+void JournalWriter::write(const JournalEntry& entry) {
+  out.put(static_cast<char>(entry.op));
+  if (entry.op == Operation::CreateVar) {
+    writeVarint(entry.label.size());
+    out.write(entry.label.data(), entry.label.size());
+  }
+  for (size_t i = 0; i < operandCount(entry.op); i++) {
+    writeVarint(entry.operands[i]);
+  }
+  writeVarint(entry.result);
+  writeVarint(entry.created.size());
+  for (const auto& node : entry.created) {
+    writeVarint(node.id);
+    writeVarint(node.top);
+    writeVarint(node.high);
+    writeVarint(node.low);
+  }
+}
+
+JournalReader::JournalReader(const std::string& path)
+    : in(path, std::ios::binary) {
+  if (!in.is_open()) {
+    throw std::runtime_error("Could not open journal: " + path);
+  }
+
+  char header[sizeof(JOURNAL_MAGIC) + 1];
+  if (!in.read(header, sizeof(header)) ||
+      !std::equal(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC),
+                  header) ||
+      header[sizeof(JOURNAL_MAGIC)] != JOURNAL_VERSION) {
+    throw std::runtime_error("Not a journal: " + path);
+  }
+}
+
+bool JournalReader::readVarint(uint64_t& value) {
+  value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    auto byte = in.get();
+    if (byte == std::ifstream::traits_type::eof()) return false;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+bool JournalReader::next(JournalEntry& entry) {
+  auto op = in.get();
+  if (op == std::ifstream::traits_type::eof()) return false;
+  if (op >= static_cast<int>(Operation::Count)) {
+    throw std::runtime_error("Corrupt journal: unknown operation");
+  }
+  entry.op = static_cast<Operation>(op);
+
+  uint64_t value;
+  entry.label.clear();
+  if (entry.op == Operation::CreateVar) {
+    if (!readVarint(value)) throw std::runtime_error("Truncated journal");
+    entry.label.resize(value);
+    if (!in.read(entry.label.data(), value)) {
+      throw std::runtime_error("Truncated journal");
+    }
+  }
+  for (size_t i = 0; i < operandCount(entry.op); i++) {
+    if (!readVarint(value)) throw std::runtime_error("Truncated journal");
+    entry.operands[i] = value;
+  }
+  if (!readVarint(value)) throw std::runtime_error("Truncated journal");
+  entry.result = value;
+
+  if (!readVarint(value)) throw std::runtime_error("Truncated journal");
+  entry.created.resize(value);
+  for (auto& node : entry.created) {
+    for (auto field : {&node.id, &node.top, &node.high, &node.low}) {
+      if (!readVarint(value)) throw std::runtime_error("Truncated journal");
+      *field = value;
+    }
+  }
+
+  return true;
+}
+
+ReplayResult replayJournal(JournalReader& journal, ManagerInterface& manager) {
+  ReplayResult replay;
+
+  /* Recorded IDs may differ from the IDs this build assigns */
+  std::unordered_map<BDD_ID, BDD_ID> ids = {{0, 0}, {1, 1}};
+  std::unordered_map<BDD_ID, JournalNode> recorded;
+
+  /* A node that is no result of its own is rebuilt from its top variable
+   * and children, which the manager finds in its unique table */
+  auto translate = [&](BDD_ID id, auto& translate) -> BDD_ID {
+    auto known = ids.find(id);
+    if (known != ids.end()) return known->second;
+
+    /* Variables are always results of createVar */
+    auto node = recorded.find(id);
+    if (node == recorded.end() || node->second.top == id) {
+      throw std::runtime_error(
+          fmt::format("Journal refers to unknown node {}", id));
+    }
+    auto result = manager.ite(translate(node->second.top, translate),
+                              translate(node->second.high, translate),
+                              translate(node->second.low, translate));
+    ids.emplace(id, result);
+    return result;
+  };
+
+  JournalEntry entry;
+  while (journal.next(entry)) {
+    std::array<BDD_ID, 3> op{};
+    for (size_t i = 0; i < operandCount(entry.op); i++) {
+      op[i] = translate(entry.operands[i], translate);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BDD_ID result;
+    switch (entry.op) {
+      case Operation::CreateVar:
+        result = manager.createVar(entry.label);
+        break;
+      case Operation::Ite:
+        result = manager.ite(op[0], op[1], op[2]);
+        break;
+      case Operation::CoFactorTrue:
+        result = manager.coFactorTrue(op[0], op[1]);
+        break;
+      case Operation::CoFactorFalse:
+        result = manager.coFactorFalse(op[0], op[1]);
+        break;
+      case Operation::And2:
+        result = manager.and2(op[0], op[1]);
+        break;
+      case Operation::Or2:
+        result = manager.or2(op[0], op[1]);
+        break;
+      case Operation::Xor2:
+        result = manager.xor2(op[0], op[1]);
+        break;
+      case Operation::Neg:
+        result = manager.neg(op[0]);
+        break;
+      case Operation::Nand2:
+        result = manager.nand2(op[0], op[1]);
+        break;
+      case Operation::Nor2:
+        result = manager.nor2(op[0], op[1]);
+        break;
+      case Operation::Xnor2:
+        result = manager.xnor2(op[0], op[1]);
+        break;
+      default:
+        throw std::runtime_error("Unsupported journal operation");
+    }
+    replay.elapsed += std::chrono::steady_clock::now() - start;
+    replay.operations++;
+
+    for (const auto& node : entry.created) recorded.emplace(node.id, node);
+
+    /* Canonicity: a recorded node must always map to the same node */
+    auto known = ids.emplace(entry.result, result);
+    if (!known.second && known.first->second != result) {
+      spdlog::warn("Operation {} ({}): expected node {}, got {}",
+                   replay.operations, operationName(entry.op),
+                   known.first->second, result);
+      replay.mismatches++;
+    }
+  }
+  return replay;
+}
+
+}  // namespace ClassProject
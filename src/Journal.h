@@ -0,0 +1,125 @@
+// Binary journal of manager operations
+//
+// A journal starts with the magic bytes "VDSJ" and a version byte, followed
+// by one record per outermost operation:
+//   - the operation as one byte (see Operation)
+//   - createVar: the label length and the label bytes
+//   - all other operations: their operands
+//   - the resulting BDD_ID
+//   - the number of nodes the operation added to the unique table, and the
+//     ID, top, high and low of each of them
+// Lengths, operands and results are LEB128 encoded, so small IDs take a
+// single byte.
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ManagerInterface.h"
+#include "ManagerStats.h"
+
+namespace ClassProject {
+
+/**
+ * @brief Node added to the unique table by a recorded operation
+ */
+struct JournalNode {
+  BDD_ID id;
+  BDD_ID top;
+  BDD_ID high;
+  BDD_ID low;
+};
+
+/**
+ * @brief One recorded operation
+ */
+struct JournalEntry {
+  Operation op;
+  std::array<BDD_ID, 3> operands;
+  BDD_ID result;
+  std::string label;  ///< Only set for createVar
+  /// Nodes created by the operation, callers may use them as operands
+  /// later, e.g. children read with getNode
+  std::vector<JournalNode> created;
+};
+
+/**
+ * @brief Number of BDD operands an operation takes
+ */
+size_t operandCount(Operation op);
+
+class JournalWriter {
+ private:
+  std::ofstream out;
+
+  void writeVarint(uint64_t value);
+
+ public:
+  /**
+   * @brief Create the journal file and write its header
+   * @param path Path of the journal
+   * @throws std::runtime_error if the file cannot be created
+   */
+  explicit JournalWriter(const std::string& path);
+
+  /**
+   * @brief Append one operation
+   * @param entry Operation, operands, result and label for createVar
+   */
+  void write(const JournalEntry& entry);
+};
+
+class JournalReader {
+ private:
+  std::ifstream in;
+
+  bool readVarint(uint64_t& value);
+
+ public:
+  /**
+   * @brief Open a journal and check its header
+   * @param path Path of the journal
+   * @throws std::runtime_error if the file cannot be opened or is no journal
+   */
+  explicit JournalReader(const std::string& path);
+
+  /**
+   * @brief Read the next operation
+   * @param entry Receives the operation
+   * @return False at the end of the journal
+   * @throws std::runtime_error if the journal is truncated or corrupt
+   */
+  bool next(JournalEntry& entry);
+};
+
+/**
+ * @brief Outcome of replayJournal
+ */
+struct ReplayResult {
+  size_t operations = 0;
+  /// Operations whose result differs from the node recorded for it before
+  size_t mismatches = 0;
+  /// Time spent in the replayed operations only
+  std::chrono::nanoseconds elapsed{0};
+};
+
+/**
+ * @brief Re-run all operations of a journal against a manager
+ *
+ * Recorded IDs are translated to the IDs of the manager. An operand that
+ * is no earlier result is rebuilt from the node the journal recorded for
+ * it, so operands read from the graph replay as well.
+ *
+ * @param journal Journal to replay
+ * @param manager Manager to run the operations on
+ * @return Number of operations, mismatches and the time spent
+ * @throws std::runtime_error if the journal refers to a node it never
+ * recorded
+ */
+ReplayResult replayJournal(JournalReader& journal, ManagerInterface& manager);
+
+}  // namespace ClassProject
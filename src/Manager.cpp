@@ -3,8 +3,11 @@
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <queue>
+#include <unordered_set>
 
 #ifndef DEBUG
 #define DEBUG 0
@@ -16,9 +19,21 @@
 #define GET_NAME(var) ((var)->id)
 #endif
 
+// Number of ite calls between two reads of the clock
+#define DEADLINE_POLL_INTERVAL 1024
+
 namespace ClassProject {
 
-Manager::Manager() {
+Manager::Manager() : Manager(std::make_shared<NodeTable>()) {}
+
+Manager::Manager(std::shared_ptr<NodeTable> table)
+    : table(std::move(table)),
+      nodes(this->table->nodes),
+      unique_table(this->table->unique_table),
+      computed_table(this->table->computed_table),
+      level_nodes(this->table->level_nodes) {
+  if (!nodes.empty()) return;
+
   nodes.push_back(std::make_shared<Node>(nodes.size(), "False"));
   auto node = nodes.back();
   node->top = node->id;
@@ -34,18 +49,176 @@ Manager::Manager() {
   unique_table[std::make_tuple(node->top, node->high, node->low)] = 1;
 }
 
+Manager::OperationScope::OperationScope(Manager& manager, Operation op,
+                                        BDD_ID a, BDD_ID b, BDD_ID c)
+    : manager(manager),
+      op(op),
+      uncaught(0),
+      operands{a, b, c},
+      label(nullptr),
+      value(0) {
+  if (manager.operation_depth == 0) {
+    manager.pollInterrupts(true);
+    manager.rollback_mark = manager.nodes.size();
+    uncaught = std::uncaught_exceptions();
+  }
+  manager.operation_depth++;
+
+  if (manager.stats_enabled) {
+    auto& stats = manager.statistics;
+    stats.callsOf(op)++;
+    stats.max_recursion_depth =
+        std::max(stats.max_recursion_depth, manager.operation_depth);
+    if (manager.operation_depth == 1) {
+      start = std::chrono::steady_clock::now();
+    }
+  }
+}
+
+Manager::OperationScope::OperationScope(Manager& manager,
+                                        const std::string& label)
+    : OperationScope(manager, Operation::CreateVar) {
+  this->label = &label;
+}
+
+Manager::OperationScope::~OperationScope() {
+  if (--manager.operation_depth != 0) return;
+
+  if (manager.stats_enabled) {
+    manager.statistics.timeOf(op) += std::chrono::steady_clock::now() - start;
+  }
+  if (std::uncaught_exceptions() > uncaught) {
+    manager.rollback(manager.rollback_mark);
+    return;
+  }
+  if (manager.record_growth) {
+    manager.growth.push_back(
+        {manager.operations_completed, op, manager.nodes.size()});
+  }
+  if (manager.journal) {
+    JournalEntry entry{op, operands, value, label ? *label : "", {}};
+    for (auto id = manager.rollback_mark; id < manager.nodes.size(); id++) {
+      const auto& node = manager.nodes[id];
+      entry.created.push_back({node->id, node->top, node->high, node->low});
+    }
+    manager.journal->write(entry);
+  }
+  manager.operations_completed++;
+}
+
+void Manager::pollInterrupts(bool force) {
+  if (cancellation.isCancelled()) {
+    throw ResourceExhausted(ResourceExhausted::Reason::Cancelled,
+                            "Operation cancelled");
+  }
+
+  if (limits.deadline == ResourceLimits::Clock::time_point::max()) return;
+  if (!force && ++polls_skipped < DEADLINE_POLL_INTERVAL) return;
+  polls_skipped = 0;
+
+  if (ResourceLimits::Clock::now() >= limits.deadline) {
+    throw ResourceExhausted(ResourceExhausted::Reason::Deadline,
+                            "Deadline exceeded");
+  }
+}
+
+void Manager::countRecursion(Operation op, size_t depth) {
+  if (!stats_enabled || depth <= operation_depth) return;
+  statistics.callsOf(op)++;
+  statistics.max_recursion_depth =
+      std::max(statistics.max_recursion_depth, depth);
+}
+
+void Manager::checkNodeBudget() {
+  if (nodes.size() >= limits.max_nodes) {
+    throw ResourceExhausted(
+        ResourceExhausted::Reason::NodeLimit,
+        fmt::format("Node limit of {} nodes reached", limits.max_nodes));
+  }
+  if (limits.max_memory != std::numeric_limits<size_t>::max() &&
+      memoryUsage() >= limits.max_memory) {
+    throw ResourceExhausted(
+        ResourceExhausted::Reason::MemoryLimit,
+        fmt::format("Memory limit of {} bytes reached", limits.max_memory));
+  }
+}
+
+void Manager::rollback(size_t mark) {
+  if (nodes.size() <= mark) return;
+
+  spdlog::debug("Rolling back {} nodes", nodes.size() - mark);
+  while (nodes.size() > mark) {
+    auto node = nodes.back();
+    unique_table.erase(std::make_tuple(node->top, node->high, node->low));
+    level_nodes[node->top]--;
+    nodes.pop_back();
+  }
+
+  // Entries of the computed table may point to or from removed nodes
+  for (auto it = computed_table.begin(); it != computed_table.end();) {
+    if (std::get<0>(it->first) >= mark || std::get<1>(it->first) >= mark ||
+        std::get<2>(it->first) >= mark || it->second >= mark) {
+      it = computed_table.erase(it);
+      if (stats_enabled) statistics.computed_evictions++;
+    } else {
+      ++it;
+    }
+  }
+}
+
+void Manager::startJournal(const std::string& path) {
+  journal = std::make_shared<JournalWriter>(path);
+}
+
+void Manager::stopJournal() { journal.reset(); }
+
+void Manager::setResourceLimits(const ResourceLimits& limits) {
+  this->limits = limits;
+}
+
+void Manager::setCancellationToken(const CancellationToken& token) {
+  cancellation = token;
+}
+
+size_t Manager::memoryUsage() const {
+  // Node and shared_ptr control block share one allocation (make_shared)
+  constexpr size_t node_bytes = sizeof(Node) + 2 * sizeof(long);
+  // Hash map node: next pointer, cached hash and the key/value pair
+  constexpr size_t entry_bytes =
+      sizeof(std::pair<const Key, BDD_ID>) + 2 * sizeof(void*);
+
+  return nodes.capacity() * sizeof(std::shared_ptr<Node>) +
+         nodes.size() * node_bytes +
+         (unique_table.size() + computed_table.size()) * entry_bytes +
+         (unique_table.bucket_count() + computed_table.bucket_count()) *
+             sizeof(void*);
+}
+
 BDD_ID Manager::createVar(const std::string& label) {
-  return createVar(label, nodes.size(), True(), False());
+  OperationScope scope(*this, label);
+  return scope.result(createVar(label, nodes.size(), True(), False()));
 }
 
 BDD_ID Manager::createVar(const std::string& label, const BDD_ID& top,
                           const BDD_ID& high, const BDD_ID& low) {
+  checkNodeBudget();
   nodes.push_back(std::make_shared<Node>(nodes.size(), label));
   auto node = nodes.back();
   node->top = top;
   node->high = high;
   node->low = low;
   unique_table[std::make_tuple(top, high, low)] = node->id;
+
+  if (level_nodes.size() <= top) level_nodes.resize(top + 1, 0);
+  level_nodes[top]++;
+
+  if (stats_enabled) {
+    statistics.unique_inserts++;
+    if (statistics.nodes_per_level.size() <= top) {
+      statistics.nodes_per_level.resize(top + 1, 0);
+    }
+    statistics.nodes_per_level[top]++;
+  }
   return node->id;
 }
 
@@ -60,6 +233,12 @@ bool Manager::isVariable(BDD_ID x) { return nodes[x]->isVariable(); }
 BDD_ID Manager::topVar(BDD_ID f) { return nodes[f]->top; }
 
 BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e) {
+  OperationScope scope(*this, Operation::Ite, i, t, e);
+  return scope.result(iteRec(i, t, e, operation_depth));
+}
+
+BDD_ID Manager::iteRec(BDD_ID i, BDD_ID t, BDD_ID e, size_t depth) {
+  countRecursion(Operation::Ite, depth);
   spdlog::trace("ite({}, {}, {})", i, t, e);
 
   // Terminal cases
@@ -69,12 +248,23 @@ BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e) {
   if (t == e) return t;
   if (t == True() && e == False()) return i;
 
+  pollInterrupts();
+
   // Check if ite has already been computed
   spdlog::trace("Checking if ite has already been computed");
   auto tuple_ite = std::make_tuple(i, t, e);
-  if (computed_table.find(tuple_ite) != computed_table.end()) {
+  auto computed = computed_table.find(tuple_ite);
+  if (stats_enabled) {
+    statistics.computed_lookups++;
+    if (computed != computed_table.end()) {
+      statistics.computed_hits++;
+    } else {
+      statistics.computed_misses++;
+    }
+  }
+  if (computed != computed_table.end()) {
     pcache_hit++;
-    return computed_table[tuple_ite];
+    return computed->second;
   }
 
   spdlog::trace("Computing ite");
@@ -87,10 +277,13 @@ BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e) {
                  top_vars.end());
 
   auto top = nodes[top_vars.front()];
-  auto high = ite(coFactorTrue(i, top->id), coFactorTrue(t, top->id),
-                  coFactorTrue(e, top->id));
-  auto low = ite(coFactorFalse(i, top->id), coFactorFalse(t, top->id),
-                 coFactorFalse(e, top->id));
+  auto next = depth + 1;
+  auto high = iteRec(coFactorTrueRec(i, top->id, next),
+                     coFactorTrueRec(t, top->id, next),
+                     coFactorTrueRec(e, top->id, next), next);
+  auto low = iteRec(coFactorFalseRec(i, top->id, next),
+                    coFactorFalseRec(t, top->id, next),
+                    coFactorFalseRec(e, top->id, next), next);
 
   // Reduce, if possible
   spdlog::trace("Reducing");
@@ -99,10 +292,18 @@ BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e) {
   // Eliminate isomorphic sub-graphs
   spdlog::trace("Eliminating isomorphic sub-graphs");
   auto tuple_vgh = std::make_tuple(top->id, high, low);
-  if (unique_table.find(tuple_vgh) != unique_table.end()) {
+  auto unique = unique_table.find(tuple_vgh);
+  if (stats_enabled) {
+    auto probe = unique_table.bucket_size(unique_table.bucket(tuple_vgh));
+    statistics.unique_lookups++;
+    statistics.unique_probes += probe;
+    statistics.unique_max_probe = std::max(statistics.unique_max_probe, probe);
+    if (unique != unique_table.end()) statistics.unique_hits++;
+  }
+  if (unique != unique_table.end()) {
     ucache_hit++;
-    computed_table[tuple_ite] = unique_table[tuple_vgh];
-    return unique_table[tuple_vgh];
+    computed_table[tuple_ite] = unique->second;
+    return unique->second;
   }
 
   // Create new node
@@ -118,96 +319,196 @@ BDD_ID Manager::ite(BDD_ID i, BDD_ID t, BDD_ID e) {
 }
 
 BDD_ID Manager::coFactorTrue(BDD_ID f, BDD_ID x) {
+  OperationScope scope(*this, Operation::CoFactorTrue, f, x);
+  return scope.result(coFactorTrueRec(f, x, operation_depth));
+}
+
+BDD_ID Manager::coFactorTrueRec(BDD_ID f, BDD_ID x, size_t depth) {
+  countRecursion(Operation::CoFactorTrue, depth);
   auto f_node = nodes[f];
 
   if (isConstant(f) || isConstant(x) || f_node->top > x) return f;
 
   if (f_node->top == x) return f_node->high;
 
-  auto T = coFactorTrue(f_node->high, x);
-  auto F = coFactorTrue(f_node->low, x);
+  auto T = coFactorTrueRec(f_node->high, x, depth + 1);
+  auto F = coFactorTrueRec(f_node->low, x, depth + 1);
 
-  return ite(f_node->top, T, F);
+  return iteRec(f_node->top, T, F, depth + 1);
 }
 
 BDD_ID Manager::coFactorFalse(BDD_ID f, BDD_ID x) {
+  OperationScope scope(*this, Operation::CoFactorFalse, f, x);
+  return scope.result(coFactorFalseRec(f, x, operation_depth));
+}
+
+BDD_ID Manager::coFactorFalseRec(BDD_ID f, BDD_ID x, size_t depth) {
+  countRecursion(Operation::CoFactorFalse, depth);
   auto f_node = nodes[f];
 
   if (isConstant(f) || isConstant(x) || f_node->top > x) return f;
 
   if (f_node->top == x) return f_node->low;
 
-  auto T = coFactorFalse(f_node->high, x);
-  auto F = coFactorFalse(f_node->low, x);
+  auto T = coFactorFalseRec(f_node->high, x, depth + 1);
+  auto F = coFactorFalseRec(f_node->low, x, depth + 1);
 
-  return ite(f_node->top, T, F);
+  return iteRec(f_node->top, T, F, depth + 1);
 }
 
 BDD_ID Manager::coFactorTrue(BDD_ID f) { return nodes[f]->high; }
 BDD_ID Manager::coFactorFalse(BDD_ID f) { return nodes[f]->low; }
 
 BDD_ID Manager::and2(BDD_ID a, BDD_ID b) {
+  OperationScope scope(*this, Operation::And2, a, b);
   spdlog::trace(">>>>>>> and2({}, {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
   auto node = nodes[ite(a, b, False())];
-  if (node->isConstant() || node->isVariable()) return node->id;
+  if (node->isConstant() || node->isVariable())
+    return scope.result(node->id);
   node->label =
       fmt::format("({} * {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
-  return node->id;
+  return scope.result(node->id);
 }
 
 BDD_ID Manager::or2(BDD_ID a, BDD_ID b) {
+  OperationScope scope(*this, Operation::Or2, a, b);
   spdlog::trace(">>>>>>> or2({}, {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
   auto node = nodes[ite(a, True(), b)];
-  if (node->isConstant() || node->isVariable()) return node->id;
+  if (node->isConstant() || node->isVariable())
+    return scope.result(node->id);
   node->label =
       fmt::format("({} + {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
-  return node->id;
+  return scope.result(node->id);
 }
 
 BDD_ID Manager::xor2(BDD_ID a, BDD_ID b) {
+  OperationScope scope(*this, Operation::Xor2, a, b);
   spdlog::trace(">>>>>>> xor2({}, {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
   auto node = nodes[ite(a, neg(b), b)];
-  if (node->isConstant() || node->isVariable()) return node->id;
+  if (node->isConstant() || node->isVariable())
+    return scope.result(node->id);
   node->label =
       fmt::format("({} x {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
-  return node->id;
+  return scope.result(node->id);
 }
 
 BDD_ID Manager::neg(BDD_ID a) {
+  OperationScope scope(*this, Operation::Neg, a);
   spdlog::trace(">>>>>>> neg({})", GET_NAME(nodes[a]));
   auto node = nodes[ite(a, False(), True())];
-  if (node->isConstant() || node->isVariable()) return node->id;
+  if (node->isConstant() || node->isVariable())
+    return scope.result(node->id);
   node->label = fmt::format("!({})", GET_NAME(nodes[a]));
-  return node->id;
+  return scope.result(node->id);
 }
 
 BDD_ID Manager::nand2(BDD_ID a, BDD_ID b) {
+  OperationScope scope(*this, Operation::Nand2, a, b);
   spdlog::trace(">>>>>>> nand2({}, {})", GET_NAME(nodes[a]),
                 GET_NAME(nodes[b]));
   auto node = nodes[neg(and2(a, b))];
-  if (node->isConstant() || node->isVariable()) return node->id;
+  if (node->isConstant() || node->isVariable())
+    return scope.result(node->id);
   node->label =
       fmt::format("!({} * {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
-  return node->id;
+  return scope.result(node->id);
 }
 
 BDD_ID Manager::nor2(BDD_ID a, BDD_ID b) {
+  OperationScope scope(*this, Operation::Nor2, a, b);
   spdlog::trace(">>>>>>> nor2({}, {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
   auto node = nodes[neg(or2(a, b))];
-  if (node->isConstant() || node->isVariable()) return node->id;
+  if (node->isConstant() || node->isVariable())
+    return scope.result(node->id);
   node->label =
       fmt::format("!({} + {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
-  return node->id;
+  return scope.result(node->id);
 }
 
 BDD_ID Manager::xnor2(BDD_ID a, BDD_ID b) {
+  OperationScope scope(*this, Operation::Xnor2, a, b);
   spdlog::trace(">>>>>>> xnor2({}, {})", GET_NAME(nodes[a]),
                 GET_NAME(nodes[b]));
   auto node = nodes[neg(xor2(a, b))];
-  if (node->isConstant() || node->isVariable()) return node->id;
+  if (node->isConstant() || node->isVariable())
+    return scope.result(node->id);
   node->label =
       fmt::format("!({} x {})", GET_NAME(nodes[a]), GET_NAME(nodes[b]));
-  return node->id;
+  return scope.result(node->id);
+}
+
+BDD_ID Manager::combineN(std::vector<BDD_ID> operands,
+                         BDD_ID (Manager::*op)(BDD_ID, BDD_ID), BDD_ID neutral,
+                         BDD_ID absorbing) {
+  std::vector<BDD_ID> remaining;
+  for (auto operand : operands) {
+    if (operand == neutral) continue;
+    if (operand == absorbing) return absorbing;
+    remaining.push_back(operand);
+  }
+  if (remaining.empty()) return neutral;
+  if (remaining.size() == 1) return remaining[0];
+  if (remaining.size() == 2) return (this->*op)(remaining[0], remaining[1]);
+
+  typedef std::pair<size_t, BDD_ID> SizedNode;
+  std::priority_queue<SizedNode, std::vector<SizedNode>,
+                      std::greater<SizedNode>>
+      queue;
+  for (auto operand : remaining) queue.emplace(nodeCount(operand), operand);
+
+  while (queue.size() > 1) {
+    auto a = queue.top().second;
+    queue.pop();
+    auto b = queue.top().second;
+    queue.pop();
+
+    auto result = (this->*op)(a, b);
+    if (result == neutral) continue;
+    if (result == absorbing) return absorbing;
+    if (queue.empty()) return result;
+    queue.emplace(nodeCount(result), result);
+  }
+
+  return queue.empty() ? neutral : queue.top().second;
+}
+
+BDD_ID Manager::andN(const std::vector<BDD_ID>& operands) {
+  std::vector<BDD_ID> unique_operands(operands);
+  std::sort(unique_operands.begin(), unique_operands.end());
+  unique_operands.erase(
+      std::unique(unique_operands.begin(), unique_operands.end()),
+      unique_operands.end());
+  return combineN(unique_operands, &Manager::and2, True(), False());
+}
+
+BDD_ID Manager::orN(const std::vector<BDD_ID>& operands) {
+  std::vector<BDD_ID> unique_operands(operands);
+  std::sort(unique_operands.begin(), unique_operands.end());
+  unique_operands.erase(
+      std::unique(unique_operands.begin(), unique_operands.end()),
+      unique_operands.end());
+  return combineN(unique_operands, &Manager::or2, False(), True());
+}
+
+BDD_ID Manager::xorN(const std::vector<BDD_ID>& operands) {
+  // XOR has no absorbing element. Passing the neutral element disables the
+  // early exit, since neutral operands and results are skipped first.
+  return combineN(operands, &Manager::xor2, False(), False());
+}
+
+size_t Manager::nodeCount(const BDD_ID& root) const {
+  std::unordered_set<BDD_ID> visited{root};
+  std::vector<BDD_ID> stack{root};
+
+  while (!stack.empty()) {
+    const auto& node = nodes[stack.back()];
+    stack.pop_back();
+    if (node->isConstant()) continue;
+    if (visited.insert(node->high).second) stack.push_back(node->high);
+    if (visited.insert(node->low).second) stack.push_back(node->low);
+  }
+
+  return visited.size();
 }
 
 void Manager::dump() {
@@ -283,7 +584,8 @@ std::string Manager::getTopVarName(const BDD_ID& root) {
 void Manager::findNodes(const BDD_ID& root, std::set<BDD_ID>& nodes_of_root) {
   auto node = nodes[root];
 
-  nodes_of_root.insert(root);
+  // Shared sub-graphs are only visited once
+  if (!nodes_of_root.insert(root).second) return;
 
   if (isConstant(root)) return;
 
@@ -292,14 +594,20 @@ void Manager::findNodes(const BDD_ID& root, std::set<BDD_ID>& nodes_of_root) {
 }
 
 void Manager::findVars(const BDD_ID& root, std::set<BDD_ID>& vars_of_root) {
-  auto node = nodes[root];
-
-  if (isConstant(root)) return;
-
-  vars_of_root.insert(node->top);
-
-  findVars(node->low, vars_of_root);
-  findVars(node->high, vars_of_root);
+  // Walk every node once, following all paths is exponential for shared
+  // sub-graphs
+  std::unordered_set<BDD_ID> visited;
+  std::vector<BDD_ID> pending = {root};
+  while (!pending.empty()) {
+    auto id = pending.back();
+    pending.pop_back();
+    if (isConstant(id) || !visited.insert(id).second) continue;
+
+    auto node = nodes[id];
+    vars_of_root.insert(node->top);
+    pending.push_back(node->low);
+    pending.push_back(node->high);
+  }
 }
 
 std::vector<BDD_ID> Manager::findVars(const BDD_ID& root) {
@@ -310,4 +618,13 @@ std::vector<BDD_ID> Manager::findVars(const BDD_ID& root) {
 
 size_t Manager::uniqueTableSize() { return nodes.size(); }
 
+std::vector<std::pair<BDD_ID, size_t>> Manager::levelHistogram() const {
+  std::vector<std::pair<BDD_ID, size_t>> histogram;
+  // Constants are their own top variable, skip them
+  for (BDD_ID var = 2; var < level_nodes.size(); var++) {
+    if (level_nodes[var] != 0) histogram.emplace_back(var, level_nodes[var]);
+  }
+  return histogram;
+}
+
 }  // namespace ClassProject
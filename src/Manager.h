@@ -12,7 +12,10 @@
 #include <string>
 #include <vector>
 
+#include "Journal.h"
 #include "ManagerInterface.h"
+#include "ManagerStats.h"
+#include "ResourceGovernor.h"
 
 namespace ClassProject {
 
@@ -58,9 +61,28 @@ struct TupleHasher {
   }
 };
 
+/**
+ * @brief Node storage of a Manager
+ * Managers constructed from the same table share all nodes and computed
+ * results, so a BDD built by one of them has the same ID in all of them.
+ */
+struct NodeTable {
+  std::vector<std::shared_ptr<Node>> nodes;
+  std::unordered_map<Key, BDD_ID, TupleHasher> unique_table;
+  std::unordered_map<Key, BDD_ID, TupleHasher> computed_table;
+  std::vector<size_t> level_nodes;
+};
+
 class Manager : public ManagerInterface {
  private:
   size_t ucache_hit = 0, pcache_hit = 0;
+
+  /**
+   * @brief Table holding the members below, possibly shared with other
+   * managers
+   */
+  std::shared_ptr<NodeTable> table;
+
   /**
    * @brief Unique table
    * The unique table is a vector of nodes
@@ -72,9 +94,9 @@ class Manager : public ManagerInterface {
    * - the ID of the low successor
    * - the ID of the high successor
    */
-  std::vector<std::shared_ptr<Node>> nodes;
+  std::vector<std::shared_ptr<Node>>& nodes;
   // T       H       L
-  std::unordered_map<Key, BDD_ID, TupleHasher> unique_table;
+  std::unordered_map<Key, BDD_ID, TupleHasher>& unique_table;
   // std::map<Key, BDD_ID> unique_table;
 
   /**
@@ -84,9 +106,126 @@ class Manager : public ManagerInterface {
    * ite-computations of the same operands are avoided.
    */
   // I       T       E
-  std::unordered_map<Key, BDD_ID, TupleHasher> computed_table;
+  std::unordered_map<Key, BDD_ID, TupleHasher>& computed_table;
   // std::map<Key, BDD_ID> computed_table;
 
+  /**
+   * @brief Resource governor
+   * Limits checked while new nodes are created, plus the cancellation token
+   * polled by ite. operation_depth counts the public operations currently on
+   * the stack, rollback_mark is the table size when the outermost one started.
+   */
+  ResourceLimits limits;
+  CancellationToken cancellation;
+  size_t operation_depth = 0;
+  size_t rollback_mark = 0;
+  size_t polls_skipped = 0;
+
+  /**
+   * @brief Instrumentation
+   * Counters are only updated while stats_enabled is set, so a disabled
+   * manager pays one predictable branch per counted event.
+   */
+  ManagerStats statistics;
+  bool stats_enabled = false;
+
+  /**
+   * @brief Node profile
+   * level_nodes holds the number of live nodes per top variable and is kept
+   * up to date on every insertion and rollback, it lives in the node table.
+   * The growth timeline is only sampled while record_growth is set.
+   */
+  std::vector<size_t>& level_nodes;
+  std::vector<GrowthSample> growth;
+  bool record_growth = false;
+  size_t operations_completed = 0;
+
+  /**
+   * @brief Journal every outermost operation is appended to, if any
+   */
+  std::shared_ptr<JournalWriter> journal;
+
+  /**
+   * @brief Scope of a public operation
+   * The outermost scope records the current table size. If it is left through
+   * an exception, every node created since then is removed again, so an
+   * aborted operation leaves the manager exactly as it found it.
+   * With statistics enabled it also counts the call and times the outermost
+   * operation. The outermost scope appends the operation to the journal, so
+   * every operation returns its value through result().
+   */
+  class OperationScope {
+   public:
+    OperationScope(Manager& manager, Operation op, BDD_ID a = 0, BDD_ID b = 0,
+                   BDD_ID c = 0);
+    OperationScope(Manager& manager, const std::string& label);
+    ~OperationScope();
+
+    BDD_ID result(BDD_ID id) {
+      value = id;
+      return id;
+    }
+
+   private:
+    Manager& manager;
+    Operation op;
+    int uncaught;
+    std::array<BDD_ID, 3> operands;
+    const std::string* label;
+    BDD_ID value;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /**
+   * @brief Throw ResourceExhausted if the deadline passed or the token was
+   * cancelled. The clock is only read every few hundred calls.
+   */
+  void pollInterrupts(bool force = false);
+
+  /**
+   * @brief Count a recursive call of ite or a cofactor at the given nesting
+   * depth. The public entry point is counted by its OperationScope, so only
+   * calls deeper than operation_depth are counted here.
+   */
+  void countRecursion(Operation op, size_t depth);
+
+  /**
+   * @brief Recursive parts of ite, coFactorTrue and coFactorFalse
+   * Only the public entry points open an OperationScope, the recursion runs
+   * inside it. depth starts at operation_depth and grows by one per call.
+   */
+  BDD_ID iteRec(BDD_ID i, BDD_ID t, BDD_ID e, size_t depth);
+  BDD_ID coFactorTrueRec(BDD_ID f, BDD_ID x, size_t depth);
+  BDD_ID coFactorFalseRec(BDD_ID f, BDD_ID x, size_t depth);
+
+  /**
+   * @brief Throw ResourceExhausted if one more node breaches the limits
+   */
+  void checkNodeBudget();
+
+  /**
+   * @brief Remove all nodes with an ID >= mark and every computed table entry
+   * that refers to them
+   */
+  void rollback(size_t mark);
+
+  /**
+   * @brief Combine operands with a binary operation, smallest BDDs first
+   *
+   * Keeps the operands in a priority queue ordered by node count and always
+   * combines the two smallest, so large intermediate results are built as
+   * late as possible.
+   *
+   * @param operands Operands to combine
+   * @param op Associative and commutative binary operation
+   * @param neutral Result for an empty operand list
+   * @param absorbing Result that cannot change any more once reached
+   * @return ID of the result node
+   */
+  BDD_ID combineN(std::vector<BDD_ID> operands,
+                  BDD_ID (Manager::*op)(BDD_ID, BDD_ID), BDD_ID neutral,
+                  BDD_ID absorbing);
+
  public:
   /**
    * @brief Constructor
@@ -94,6 +233,26 @@ class Manager : public ManagerInterface {
    */
   Manager();
 
+  /**
+   * @brief Attach to a node table
+   *
+   * Creates the constants if the table is empty. Resource limits, statistics
+   * and the journal stay per manager, but a rollback removes the nodes the
+   * aborted operation added to the shared table. Managers sharing a table
+   * must not run operations concurrently.
+   *
+   * @param table Table to share, e.g. nodeTable() of another manager
+   */
+  explicit Manager(std::shared_ptr<NodeTable> table);
+
+  Manager(const Manager&) = delete;
+  Manager& operator=(const Manager&) = delete;
+
+  /**
+   * @brief Node table of this manager, to attach other managers to
+   */
+  std::shared_ptr<NodeTable> nodeTable() const { return table; }
+
   /**
    * @brief Create a new variable
    * Creates a new variable with the given label and returns its ID.
@@ -241,6 +400,37 @@ class Manager : public ManagerInterface {
    */
   BDD_ID xnor2(BDD_ID a, BDD_ID b) override;
 
+  /**
+   * @brief Compute the AND of any number of nodes
+   *
+   * Operands are combined smallest first instead of folding from the left.
+   *
+   * @param operands IDs of the nodes
+   * @return ID of the result node, True if operands is empty
+   */
+  BDD_ID andN(const std::vector<BDD_ID>& operands) override;
+
+  /**
+   * @brief Compute the OR of any number of nodes
+   * @param operands IDs of the nodes
+   * @return ID of the result node, False if operands is empty
+   */
+  BDD_ID orN(const std::vector<BDD_ID>& operands) override;
+
+  /**
+   * @brief Compute the XOR of any number of nodes
+   * @param operands IDs of the nodes
+   * @return ID of the result node, False if operands is empty
+   */
+  BDD_ID xorN(const std::vector<BDD_ID>& operands) override;
+
+  /**
+   * @brief Count the nodes of a BDD, including the terminal nodes
+   * @param root ID of the root node
+   * @return Number of distinct nodes reachable from root
+   */
+  size_t nodeCount(const BDD_ID& root) const;
+
   void dump();
 
   std::string getTopVarName(const BDD_ID& root) override;
@@ -252,7 +442,14 @@ class Manager : public ManagerInterface {
 
   size_t uniqueTableSize() override;
 
+  /**
+   * @brief Number of ite results found in the unique table
+   */
   size_t ucache_hits() override { return ucache_hit; }
+
+  /**
+   * @brief Number of ite results found in the computed table
+   */
   size_t pcache_hits() override { return pcache_hit; }
 
   // Not implemented yet
@@ -266,5 +463,83 @@ class Manager : public ManagerInterface {
   void mermaidGraph(std::string filepath, BDD_ID& root);
 
   const std::shared_ptr<Node> getNode(const BDD_ID& id) const;
+
+  /**
+   * @brief Set the node, memory and deadline limits of this manager
+   *
+   * A breach aborts the current top-level operation with ResourceExhausted
+   * and leaves the manager in the state it had before that operation.
+   *
+   * @param limits New limits
+   */
+  void setResourceLimits(const ResourceLimits& limits);
+  const ResourceLimits& resourceLimits() const { return limits; }
+
+  /**
+   * @brief Attach a cancellation token
+   *
+   * Another thread may call cancel() on a copy of the token to abort the
+   * running operation. The token stays cancelled until reset() is called.
+   *
+   * @param token Token to poll
+   */
+  void setCancellationToken(const CancellationToken& token);
+  const CancellationToken& cancellationToken() const { return cancellation; }
+
+  /**
+   * @brief Estimated memory used by the unique and computed tables in bytes
+   */
+  size_t memoryUsage() const;
+
+  /**
+   * @brief Enable or disable collection of statistics
+   * @param enable True to start counting, False to stop
+   */
+  void enableStats(bool enable = true) { stats_enabled = enable; }
+  bool statsEnabled() const { return stats_enabled; }
+
+  /**
+   * @brief Counters collected since the last resetStats()
+   */
+  const ManagerStats& stats() const { return statistics; }
+  void resetStats() { statistics = ManagerStats(); }
+
+  /**
+   * @brief Number of live nodes per variable
+   *
+   * Entries are ordered by variable order and only include variables that
+   * label at least one node.
+   *
+   * @return Pairs of variable ID and node count
+   */
+  std::vector<std::pair<BDD_ID, size_t>> levelHistogram() const;
+
+  /**
+   * @brief Record the unique table size after every outermost operation
+   * @param enable True to start sampling, False to stop
+   */
+  void recordGrowth(bool enable = true) { record_growth = enable; }
+
+  /**
+   * @brief Samples recorded since recording was enabled
+   */
+  const std::vector<GrowthSample>& growthTimeline() const { return growth; }
+  void clearGrowthTimeline() { growth.clear(); }
+
+  /**
+   * @brief Record every outermost operation to a binary journal
+   *
+   * The journal can be re-run against any manager build with
+   * VDSProject_replay. Starting a new journal closes the previous one.
+   *
+   * @param path Path of the journal file
+   * @throws std::runtime_error if the file cannot be created
+   */
+  void startJournal(const std::string& path);
+
+  /**
+   * @brief Stop recording and close the journal
+   */
+  void stopJournal();
 };
 }  // namespace ClassProject
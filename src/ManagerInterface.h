@@ -49,6 +49,12 @@ class ManagerInterface {
 
   virtual BDD_ID xnor2(BDD_ID a, BDD_ID b) = 0;
 
+  virtual BDD_ID andN(const std::vector<BDD_ID>& operands) = 0;
+
+  virtual BDD_ID orN(const std::vector<BDD_ID>& operands) = 0;
+
+  virtual BDD_ID xorN(const std::vector<BDD_ID>& operands) = 0;
+
   virtual std::string getTopVarName(const BDD_ID& root) = 0;
 
   virtual void findNodes(const BDD_ID& root,
@@ -0,0 +1,71 @@
+#include "ManagerStats.h"
+
+#include <fmt/format.h>
+
+namespace ClassProject {
+
+const char* operationName(Operation op) {
+  switch (op) {
+    case Operation::CreateVar:
+      return "createVar";
+    case Operation::Ite:
+      return "ite";
+    case Operation::CoFactorTrue:
+      return "coFactorTrue";
+    case Operation::CoFactorFalse:
+      return "coFactorFalse";
+    case Operation::And2:
+      return "and2";
+    case Operation::Or2:
+      return "or2";
+    case Operation::Xor2:
+      return "xor2";
+    case Operation::Neg:
+      return "neg";
+    case Operation::Nand2:
+      return "nand2";
+    case Operation::Nor2:
+      return "nor2";
+    case Operation::Xnor2:
+      return "xnor2";
+    default:
+      return "unknown";
+  }
+}
+
+std::string ManagerStats::toJson() const {
+  std::string json = "{\n  \"operations\": {";
+  for (size_t op = 0; op < OPERATION_COUNT; op++) {
+    json += fmt::format("{}\n    \"{}\": {{\"calls\": {}, \"time_ns\": {}}}",
+                        op ? "," : "",
+                        operationName(static_cast<Operation>(op)), calls[op],
+                        time[op].count());
+  }
+  json += "\n  },\n";
+
+  json += fmt::format(
+      "  \"computed_table\": {{\"lookups\": {}, \"hits\": {}, \"misses\": {}, "
+      "\"evictions\": {}}},\n",
+      computed_lookups, computed_hits, computed_misses, computed_evictions);
+  json += fmt::format(
+      "  \"unique_table\": {{\"lookups\": {}, \"hits\": {}, \"inserts\": {}, "
+      "\"probes\": {}, \"max_probe\": {}}},\n",
+      unique_lookups, unique_hits, unique_inserts, unique_probes,
+      unique_max_probe);
+
+  json += "  \"nodes_per_level\": {";
+  bool first = true;
+  for (size_t var = 0; var < nodes_per_level.size(); var++) {
+    if (nodes_per_level[var] == 0) continue;
+    json += fmt::format("{}\"{}\": {}", first ? "" : ", ", var,
+                        nodes_per_level[var]);
+    first = false;
+  }
+  json += "},\n";
+
+  json += fmt::format("  \"max_recursion_depth\": {}\n}}\n",
+                      max_recursion_depth);
+  return json;
+}
+
+}  // namespace ClassProject
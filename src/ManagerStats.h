@@ -0,0 +1,100 @@
+// Instrumentation counters of the BDD manager
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace ClassProject {
+
+/**
+ * @brief Public operations of the manager that are counted and timed
+ */
+enum class Operation {
+  CreateVar,
+  Ite,
+  CoFactorTrue,
+  CoFactorFalse,
+  And2,
+  Or2,
+  Xor2,
+  Neg,
+  Nand2,
+  Nor2,
+  Xnor2,
+  Count  ///< Number of operations, not an operation itself
+};
+
+constexpr size_t OPERATION_COUNT = static_cast<size_t>(Operation::Count);
+
+/**
+ * @brief Name of an operation as used in the JSON export
+ */
+const char* operationName(Operation op);
+
+/**
+ * @brief Counters collected by a Manager while statistics are enabled
+ */
+struct ManagerStats {
+  /**
+   * @brief Number of calls per operation, including recursive calls
+   */
+  std::array<size_t, OPERATION_COUNT> calls{};
+
+  /**
+   * @brief Wall-clock time per operation
+   * Only the outermost operation is timed, so nested calls are attributed to
+   * the operation the caller actually invoked.
+   */
+  std::array<std::chrono::nanoseconds, OPERATION_COUNT> time{};
+
+  size_t computed_lookups = 0;
+  size_t computed_hits = 0;
+  size_t computed_misses = 0;
+  size_t computed_evictions = 0;  ///< Entries dropped by a rollback
+
+  size_t unique_lookups = 0;
+  size_t unique_hits = 0;
+  size_t unique_inserts = 0;
+  size_t unique_probes = 0;     ///< Sum of bucket lengths seen by lookups
+  size_t unique_max_probe = 0;  ///< Longest bucket seen by a lookup
+
+  /**
+   * @brief Nodes created per variable, indexed by the variable's BDD_ID
+   */
+  std::vector<size_t> nodes_per_level;
+
+  /**
+   * @brief Deepest nesting of manager operations
+   */
+  size_t max_recursion_depth = 0;
+
+  size_t& callsOf(Operation op) { return calls[static_cast<size_t>(op)]; }
+  size_t callsOf(Operation op) const {
+    return calls[static_cast<size_t>(op)];
+  }
+
+  std::chrono::nanoseconds& timeOf(Operation op) {
+    return time[static_cast<size_t>(op)];
+  }
+  std::chrono::nanoseconds timeOf(Operation op) const {
+    return time[static_cast<size_t>(op)];
+  }
+
+  /**
+   * @brief Serialize all counters as a JSON object
+   */
+  std::string toJson() const;
+};
+
+/**
+ * @brief Size of the unique table after an outermost operation
+ */
+struct GrowthSample {
+  size_t operation;  ///< Running number of the outermost operation
+  Operation op;
+  size_t unique_table_size;
+};
+
+}  // namespace ClassProject
@@ -0,0 +1,65 @@
+// Resource limits and cooperative cancellation for the BDD manager
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace ClassProject {
+
+/**
+ * @brief Limits enforced by a Manager while it builds new nodes
+ *
+ * Every limit defaults to "unlimited". The deadline is an absolute point in
+ * time, e.g. `std::chrono::steady_clock::now() + std::chrono::seconds(10)`.
+ */
+struct ResourceLimits {
+  typedef std::chrono::steady_clock Clock;
+
+  size_t max_nodes = std::numeric_limits<size_t>::max();
+  size_t max_memory = std::numeric_limits<size_t>::max();  ///< Bytes
+  Clock::time_point deadline = Clock::time_point::max();
+};
+
+/**
+ * @brief Cancellation flag shared between a Manager and other threads
+ *
+ * Copies share the same flag, so a copy handed to a watchdog thread can
+ * cancel the operation currently running in the Manager.
+ */
+class CancellationToken {
+ private:
+  std::shared_ptr<std::atomic<bool>> flag;
+
+ public:
+  CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+  void cancel() { flag->store(true, std::memory_order_relaxed); }
+  void reset() { flag->store(false, std::memory_order_relaxed); }
+  bool isCancelled() const { return flag->load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Thrown when an operation breaches a ResourceLimits entry or is
+ * cancelled
+ *
+ * The Manager rolls back every node created by the aborted top-level
+ * operation before the exception leaves it.
+ */
+class ResourceExhausted : public std::runtime_error {
+ public:
+  enum class Reason { NodeLimit, MemoryLimit, Deadline, Cancelled };
+
+  ResourceExhausted(Reason reason, const std::string& what)
+      : std::runtime_error(what), reason_(reason) {}
+
+  Reason reason() const { return reason_; }
+
+ private:
+  Reason reason_;
+};
+
+}  // namespace ClassProject
@@ -7,6 +7,7 @@
 
 BenchParser::BenchParser(const std::string &bench_file) {
   id_counter = 0;
+  symbols = std::make_shared<SymbolTable>();
 
   if (parseFile(bench_file)) {
     /* Based on the list of output labels, generate the corresponding circuit */
@@ -38,20 +39,22 @@ BenchParser::~BenchParser() = default;
  * ---------------
  */
 void BenchParser::PrintLabelsTable() {
-  std::unordered_map<label_t, bench_node_t>::const_iterator it_label;
+  std::unordered_map<node_key_t, bench_node_t>::const_iterator it_label;
 
   std::cout << "============ [BEGIN] Table of Labels and Nodes ============"
             << std::endl;
   std::cout << std::endl << "-----" << std::endl;
   for (it_label = label_to_node.begin(); it_label != label_to_node.end();
        it_label++) {
-    std::cout << std::endl << "Label: " << it_label->first << std::endl;
+    std::cout << std::endl << "Key: " << it_label->first << std::endl;
     std::cout << "Node Information:" << std::endl;
-    std::cout << "\tNode Label: " << it_label->second.label << std::endl;
-    std::cout << "\tGate Type: " << it_label->second.gate_type << std::endl;
+    std::cout << "\tNode Label: " << symbols->name(it_label->second.label)
+              << std::endl;
+    std::cout << "\tGate Type: " << GateTypeName(it_label->second.gate_type)
+              << std::endl;
     std::cout << "\tInputs: ";
     for (const auto &i : it_label->second.input_node_list)
-      std::cout << i << ' ';
+      std::cout << symbols->name(i) << ' ';
     std::cout << std::endl << "-----" << std::endl;
   }
   std::cout << "============ [END] Table of Labels and Nodes ============"
@@ -68,8 +71,10 @@ void BenchParser::PrintUUIDCircuitTable() {
        it_uuid != id_to_circuit_node.end(); it_uuid++) {
     std::cout << std::endl << "UUID: " << it_uuid->first << std::endl;
     std::cout << "Node Information:" << std::endl;
-    std::cout << "\tNode Circuit Label: " << it_uuid->second.label << std::endl;
-    std::cout << "\tGate Type: " << it_uuid->second.gate_type << std::endl;
+    std::cout << "\tNode Circuit Label: "
+              << symbols->name(it_uuid->second.label) << std::endl;
+    std::cout << "\tGate Type: " << GateTypeName(it_uuid->second.gate_type)
+              << std::endl;
     std::cout << "\tInputs: ";
     for (unsigned long i : it_uuid->second.input_id_list) std::cout << i << ' ';
     std::cout << std::endl << "-----" << std::endl;
@@ -83,14 +88,14 @@ void BenchParser::PrintUUIDCircuitTable() {
 }
 
 void BenchParser::PrintOutputList() {
-  std::set<label_t>::const_iterator it;
+  std::set<symbol_t>::const_iterator it;
 
   std::cout << std::endl
             << "============ [BEGIN] List of Outputs ============" << std::endl
             << std::endl;
   std::cout << std::endl << "List of output labels: ";
   for (it = output_labels.begin(); it != output_labels.end(); it++) {
-    std::cout << (*it) << " -> ";
+    std::cout << symbols->name(*it) << " -> ";
   }
   std::cout << "end;" << std::endl;
   std::cout << std::endl
@@ -98,14 +103,14 @@ void BenchParser::PrintOutputList() {
 }
 
 void BenchParser::PrintLabels2UUIDTable() {
-  std::unordered_map<label_t, unique_ID_t>::const_iterator it_label;
+  std::unordered_map<node_key_t, unique_ID_t>::const_iterator it_label;
 
   std::cout << "============ [BEGIN] Table of Labels and UUIDs ============"
             << std::endl;
   std::cout << std::endl << "-----" << std::endl;
   for (it_label = labels_to_id.begin(); it_label != labels_to_id.end();
        it_label++) {
-    std::cout << std::endl << "Label: " << it_label->first << std::endl;
+    std::cout << std::endl << "Key: " << it_label->first << std::endl;
     std::cout << std::endl << "UUID: " << it_label->second << std::endl;
     std::cout << std::endl << "------------------------------" << std::endl;
   }
@@ -122,10 +127,10 @@ void BenchParser::PrintCircuit(unique_ID_t circuit_ID, int indent) {
     node = got->second;
     std::cout << std::string(indent, ' ') << "Node ID: " << node.id
               << std::endl;
-    std::cout << std::string(indent, ' ') << "Label: " << node.label
-              << std::endl;
-    std::cout << std::string(indent, ' ') << "Type: " << node.gate_type
-              << std::endl;
+    std::cout << std::string(indent, ' ') << "Label: "
+              << symbols->name(node.label) << std::endl;
+    std::cout << std::string(indent, ' ')
+              << "Type: " << GateTypeName(node.gate_type) << std::endl;
 
     std::cout << std::string(indent, ' ') << "Input List: " << std::endl;
     for (unsigned long i : node.input_id_list)
@@ -142,10 +147,10 @@ void BenchParser::PrintCircuit(unique_ID_t circuit_ID, int indent) {
   }
 }
 
-void BenchParser::PrintCircuitByLabel(const label_t &node_label) {
-  std::unordered_map<label_t, unique_ID_t>::const_iterator got;
+void BenchParser::PrintCircuitByLabel(symbol_t node_label) {
+  std::unordered_map<node_key_t, unique_ID_t>::const_iterator got;
 
-  got = (labels_to_id).find(node_label);
+  got = (labels_to_id).find(NodeKey(node_label));
   if (got != labels_to_id.end()) {
     PrintCircuit(got->second, 0);
   } else {
@@ -193,7 +198,11 @@ set_of_circuit_t BenchParser::GetListOfCircuitsOutputs() {
   return output_circuits;
 }
 
-std::set<label_t> BenchParser::GetListOfOutputLabels() { return outputs; }
+std::vector<symbol_t> BenchParser::GetListOfOutputLabels() { return outputs; }
+
+std::shared_ptr<const SymbolTable> BenchParser::GetSymbols() const {
+  return symbols;
+}
 
 circuit_node_t BenchParser::GetCircuitNode(unique_ID_t circuit_node_uuid) {
   /* Iterator for the uuid2circuitNode_table table */
@@ -224,43 +233,27 @@ list_of_circuit_t BenchParser::GetSortedCircuit() { return sorted_circuit; }
  */
 bool BenchParser::parseFile(const std::string &bench_file) {
   std::cout << std::endl << "- Reading bench format file... ";
-  std::ifstream in(bench_file);
-  if (!in.is_open()) {
-    throw std::runtime_error("Could not open file: " + bench_file);
-  }
-  in.unsetf(std::ios::skipws);
+  BenchTokenizer tokenizer(bench_file);
   std::cout << "Done!" << std::endl;
 
-  /* Declaring file iterators */
-  boost::spirit::istream_iterator first(in), last;
-
-  /* Declaring skip parser to be used */
-  skip_p::skip_grammar<boost::spirit::istream_iterator> skip;
-
-  /* Declaring bench format grammar */
-  bench_format::bench_parser<boost::spirit::istream_iterator>
-      bench_grammar_parser;
-
-  /* Stored result after parsing a file line */
-  bench_format::bench_node_type parsed_bench_node;
-
-  /* Effectively parsing the file. The parser returns a benchnode to be added to
-   * the labels table */
+  /* Effectively parsing the file. Each statement becomes a bench node to be
+   * added to the labels table */
   std::cout << "- Parsing input file '" << bench_file << "'... ";
-  bool successfully_parsed;
-  do {
-    successfully_parsed = phrase_parse(first, last, bench_grammar_parser, skip,
-                                       parsed_bench_node);
-    if (!successfully_parsed) {
-      std::cout << "Failed parsing input file at: " << std::string(first, last)
-                << std::endl;
-      return false;
-    } else {
-      /* Add the successfully read bench node into the labels table */
-      addToLabelTable(parsed_bench_node);
+  bench_format::bench_record_type record;
+  try {
+    while (tokenizer.next(record)) {
+      bench_node_t parsed_bench_node;
+      parsed_bench_node.label = symbols->intern(record.label);
+      parsed_bench_node.gate_type = record.gate_type;
+      for (const auto &input : record.inputs) {
+        parsed_bench_node.input_node_list.push_back(symbols->intern(input));
+      }
+      addToLabelTable(std::move(parsed_bench_node));
     }
-    parsed_bench_node = bench_format::bench_node_type();
-  } while (first != last); /* Operations are performed until it is EOF */
+  } catch (const std::runtime_error &e) {
+    std::cout << "Failed parsing input file at: " << e.what() << std::endl;
+    return false;
+  }
   std::cout << "Done!" << std::endl;
 
   return true;
@@ -268,47 +261,47 @@ bool BenchParser::parseFile(const std::string &bench_file) {
 
 bool BenchParser::addToLabelTable(bench_node_t bench_node) {
   bool new_node_added;
-  label_t search_label;
+  node_key_t search_key;
   /*
    * Output nodes have to be handle a bit different, since they'll have
    *  the same label as another gate. Mappings require unique element
-   *  identifiers. By convention, OUTPUT gates will be referenced by its
-   *  original label concatenated with the string "OUTPUT" to differentiate
-   *  from the other gate that has the same label.
+   *  identifiers. By convention, OUTPUT gates will be referenced by the
+   *  key of its original label tagged as OUTPUT to differentiate from the
+   *  other gate that has the same label.
    */
-  if (bench_node.gate_type == OUTPUT_GATE_T) {
+  if (bench_node.gate_type == GateType::Output) {
     /* If the gate is an output gate, it must be included into the
      * set_of_output_labels */
     output_labels.insert(bench_node.label);
-    search_label = bench_node.label + bench_node.gate_type;
+    search_key = NodeKey(bench_node.label, GateType::Output);
   } else {
-    search_label = bench_node.label;
+    search_key = NodeKey(bench_node.label);
   }
 
-  if (label_to_node.find(search_label) != label_to_node.end()) {
+  if (label_to_node.find(search_key) != label_to_node.end()) {
     new_node_added = false;
   } else {
     /*
      * Otherwise add bench_node to the labels_table
      */
-    if (bench_node.gate_type == FLIP_FLOP_GATE_T) {
+    if (bench_node.gate_type == GateType::FlipFlop) {
       /* If it is a flip flop, we have to add two nodes:
          One that will be the output node;
          Another one as input node.
          For the searching part it is not necessary to differentiate it,
          since for each existing flip flop in the circuit we will add
          to the labels table one node that is an INPUT with the same
-         label as the flip flop, and another one with the "FLIP_FLOP_GATE_T"
-         string concatenated. So if we search for one of them, it is
-         enough to check whether the node exists or not. */
-      ff_labels.insert(search_label);
-      label_to_node.insert(std::pair<label_t, bench_node_t>(
-          search_label + FLIP_FLOP_GATE_T, bench_node));
-      bench_node.gate_type = INPUT_GATE_T;
+         label as the flip flop, and another one with the key tagged as
+         FLIP FLOP. So if we search for one of them, it is enough to check
+         whether the node exists or not. */
+      ff_labels.insert(bench_node.label);
+      label_to_node.insert(std::pair<node_key_t, bench_node_t>(
+          NodeKey(bench_node.label, GateType::FlipFlop), bench_node));
+      bench_node.gate_type = GateType::Input;
       bench_node.input_node_list.clear();
     }
     label_to_node.insert(
-        std::pair<label_t, bench_node_t>(search_label, bench_node));
+        std::pair<node_key_t, bench_node_t>(search_key, bench_node));
     new_node_added = true;
   }
   return new_node_added;
@@ -316,18 +309,11 @@ bool BenchParser::addToLabelTable(bench_node_t bench_node) {
 
 unique_ID_t BenchParser::findOrAddToCircuit(const bench_node_t &bench_node) {
   unique_ID_t CircuitNodeID;
-  std::unordered_map<label_t, unique_ID_t>::const_iterator got;
+  std::unordered_map<node_key_t, unique_ID_t>::const_iterator got;
   circuit_node_t new_circuit_node;
-  label_t search_label;
-
-  if ((bench_node.gate_type == OUTPUT_GATE_T) ||
-      (bench_node.gate_type == FLIP_FLOP_GATE_T)) {
-    search_label = bench_node.label + bench_node.gate_type;
-  } else {
-    search_label = bench_node.label;
-  }
+  node_key_t search_key = NodeKey(bench_node.label, bench_node.gate_type);
 
-  got = labels_to_id.find(search_label);
+  got = labels_to_id.find(search_key);
 
   if (got != labels_to_id.end()) {
     /* If the iterator is not pointing to the end of the labels_table,
@@ -341,15 +327,15 @@ unique_ID_t BenchParser::findOrAddToCircuit(const bench_node_t &bench_node) {
     new_circuit_node = benchNodeToCircuitNode(bench_node);
     CircuitNodeID = new_circuit_node.id;
     labels_to_id.insert(
-        std::pair<label_t, unique_ID_t>(search_label, CircuitNodeID));
+        std::pair<node_key_t, unique_ID_t>(search_key, CircuitNodeID));
     id_to_circuit_node.insert(std::pair<unique_ID_t, circuit_node_t>(
         CircuitNodeID, new_circuit_node));
   }
   return CircuitNodeID;
 }
 
-unique_ID_t BenchParser::findOrAddToCircuitByLabel(const label_t &node_label) {
-  auto label = (label_to_node).find(node_label);
+unique_ID_t BenchParser::findOrAddToCircuitByLabel(node_key_t node_key) {
+  auto label = (label_to_node).find(node_key);
 
   if (label != label_to_node.end()) {
     return (findOrAddToCircuit(label->second));
@@ -358,6 +344,16 @@ unique_ID_t BenchParser::findOrAddToCircuitByLabel(const label_t &node_label) {
   }
 }
 
+node_key_t BenchParser::NodeKey(symbol_t label, GateType gate_type) {
+  node_key_t variant = 0;
+  if (gate_type == GateType::Output) {
+    variant = 1;
+  } else if (gate_type == GateType::FlipFlop) {
+    variant = 2;
+  }
+  return (static_cast<node_key_t>(label) << 2) | variant;
+}
+
 circuit_node_t BenchParser::benchNodeToCircuitNode(
     const bench_node_t &bench_node) {
   circuit_node_t new_circuit_node;
@@ -373,9 +369,9 @@ circuit_node_t BenchParser::benchNodeToCircuitNode(
 
   /* If it is not an INPUT gate, we have to recursively iterate to get the
    * unique id of the inputs */
-  if (!(new_circuit_node.gate_type == INPUT_GATE_T)) {
-    if (new_circuit_node.gate_type == OUTPUT_GATE_T) {
-      input_id = findOrAddToCircuitByLabel(bench_node.label);
+  if (!(new_circuit_node.gate_type == GateType::Input)) {
+    if (new_circuit_node.gate_type == GateType::Output) {
+      input_id = findOrAddToCircuitByLabel(NodeKey(bench_node.label));
       new_circuit_node.input_id_list.insert(input_id);
 
       auto node = id_to_circuit_node.find(input_id);
@@ -385,7 +381,7 @@ circuit_node_t BenchParser::benchNodeToCircuitNode(
 
     } else {
       for (const auto &input_node : bench_node.input_node_list) {
-        input_id = findOrAddToCircuitByLabel(input_node);
+        input_id = findOrAddToCircuitByLabel(NodeKey(input_node));
         new_circuit_node.input_id_list.insert(input_id);
 
         auto node = id_to_circuit_node.find(input_id);
@@ -402,28 +398,35 @@ circuit_node_t BenchParser::benchNodeToCircuitNode(
 }
 
 void BenchParser::createCircuitFromOutputList() {
-  std::set<label_t>::const_iterator it;
-  std::unordered_map<label_t, unique_ID_t>::const_iterator got_uid;
-  std::unordered_map<unique_ID_t, circuit_node_t>::const_iterator got_node;
-
-  for (const auto &output_label : output_labels) {
-    createCircuitByLabel(output_label + OUTPUT_GATE_T);
+  /* Circuit IDs and thus the variable order follow the labels, not the order
+   * the symbols were interned in */
+  std::vector<symbol_t> sorted_outputs(output_labels.begin(),
+                                       output_labels.end());
+  std::vector<symbol_t> sorted_ffs(ff_labels.begin(), ff_labels.end());
+  symbols->sortByName(sorted_outputs);
+  symbols->sortByName(sorted_ffs);
+
+  for (const auto &output_label : sorted_outputs) {
+    createCircuitByLabel(NodeKey(output_label, GateType::Output));
   }
-  for (const auto &ff_label : ff_labels) {
-    createCircuitByLabel(ff_label + FLIP_FLOP_GATE_T);
+  for (const auto &ff_label : sorted_ffs) {
+    createCircuitByLabel(NodeKey(ff_label, GateType::FlipFlop));
   }
-  for (const auto &ff_label : ff_labels) {
-    auto ff_id = labels_to_id.find(ff_label + FLIP_FLOP_GATE_T);
+
+  std::set<symbol_t> output_set(output_labels.begin(), output_labels.end());
+  for (const auto &ff_label : sorted_ffs) {
+    auto ff_id = labels_to_id.find(NodeKey(ff_label, GateType::FlipFlop));
     auto ff_node = id_to_circuit_node.find(ff_id->second);
     ff_node = id_to_circuit_node.find(*(ff_node->second).input_id_list.begin());
-    outputs.insert(ff_node->second.label);
+    output_set.insert(ff_node->second.label);
   }
-  outputs.insert(output_labels.begin(), output_labels.end());
+  outputs.assign(output_set.begin(), output_set.end());
+  symbols->sortByName(outputs);
 }
 
-void BenchParser::createCircuitByLabel(const label_t &bnode_label) {
+void BenchParser::createCircuitByLabel(node_key_t bnode_key) {
   unique_ID_t new_circuit;
-  new_circuit = findOrAddToCircuitByLabel(bnode_label);
+  new_circuit = findOrAddToCircuitByLabel(bnode_key);
   output_circuits.insert(new_circuit);
 }
 
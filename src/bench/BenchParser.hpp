@@ -7,23 +7,16 @@
 
 #include <boost/algorithm/string.hpp>
 #include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <set>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 
+#include "BenchTokenizer.hpp"
 #include "BenchmarkLib.h"
-#include "bench_grammar.hpp"
-#include "skip_parser.hpp"
-
-#define OUTPUT_GATE_T "OUTPUT"
-#define INPUT_GATE_T "INPUT"
-#define FLIP_FLOP_GATE_T "DFF"
-#define BUFFER_GATE_T "BUFF"
-#define NOT_GATE_T "NOT"
-#define AND_GATE_T "AND"
-#define OR_GATE_T "OR"
-#define NAND_GATE_T "NAND"
-#define NOR_GATE_T "NOR"
-#define XOR_GATE_T "XOR"
 
 /* Type definitions */
 typedef std::string label_t;  ///< Type definition for labels
@@ -34,6 +27,8 @@ typedef size_t
     unique_ID_t;  ///< Type definition for unique identifiers for circuits
 typedef std::set<size_t>
     set_of_circuit_t;  ///< Type definition for set of circuits
+typedef uint64_t node_key_t;  ///< Type definition for a label and the OUTPUT
+                              ///< or FLIP FLOP variant of its node
 
 /**
  * \struct circuit_node_type
@@ -41,9 +36,9 @@ typedef std::set<size_t>
  *
  */
 typedef struct circuit_node_t {
-  size_t id;              ///< Unique ID for a node
-  std::string label;      ///< Node Label
-  std::string gate_type;  ///< Type of the gate (ex. AND, NOT, OR)
+  size_t id;           ///< Unique ID for a node
+  symbol_t label;      ///< Node Label
+  GateType gate_type;  ///< Type of the gate (ex. AND, NOT, OR)
   std::set<size_t>
       input_id_list;  ///< set containing all the inputs of the respective gate
   std::set<size_t> output_id_list;  ///< set containing all the outputs of the
@@ -67,24 +62,26 @@ class BenchParser {
  private:
   size_t id_counter;
 
-  std::set<label_t>
+  std::shared_ptr<SymbolTable> symbols;  ///< Labels of the bench nodes
+
+  std::set<symbol_t>
       output_labels;  ///< Set containing bench node labels of all OUTPUT gates
-  std::set<label_t>
+  std::set<symbol_t>
       ff_labels;  ///< Set containing bench node labels of all FLIP FLOP gates.
   ///<  When a FLIP FLOP gate is parsed, it is split into two circuit's gates:
   ///< one will be handled as INPUT gate and the other one as OUTPUT gate.
 
-  std::set<label_t> outputs;
+  std::vector<symbol_t> outputs;  ///< Labels to print a BDD for, sorted
 
   std::set<size_t>
       output_circuits;  ///< Set containing the unique ID of all OUTPUT gates
   std::set<size_t>
       input_circuits;  ///< Set containing the unique ID of all INPUT gates
 
-  std::unordered_map<label_t, bench_node_t>
-      label_to_node;  ///< Mapping from bench node labels to bench node
-  std::unordered_map<label_t, size_t>
-      labels_to_id;  ///< Mapping from bench node labels to circuit unique IDs
+  std::unordered_map<node_key_t, bench_node_t>
+      label_to_node;  ///< Mapping from bench node keys to bench node
+  std::unordered_map<node_key_t, size_t>
+      labels_to_id;  ///< Mapping from bench node keys to circuit unique IDs
   std::unordered_map<size_t, circuit_node_t>
       id_to_circuit_node;  ///< Mapping from circuit unique IDs to circuit nodes
 
@@ -143,11 +140,11 @@ class BenchParser {
 
   /**
    * \brief prints the circuit starting from the given label's node.
-   * \param node_label is label_t
+   * \param node_label is symbol_t
    * \return none
    *
    */
-  void PrintCircuitByLabel(const label_t& node_label);
+  void PrintCircuitByLabel(symbol_t node_label);
 
   /**
    * \brief prints all circuits from the set of circuit OUTPUTS.
@@ -210,7 +207,8 @@ class BenchParser {
    * \param bench_file is std::string.
    * \return bool returns true in case of success.
    *
-   *  Reads the file containing the circuit in the bench format.
+   *  Reads the file containing the circuit in the bench format with a
+   *   BenchTokenizer, in a single pass over the mapped file.
    */
   bool parseFile(const std::string& bench_file);
 
@@ -245,17 +243,30 @@ class BenchParser {
   unique_ID_t findOrAddToCircuit(const bench_node_t& bench_node);
 
   /**
-   * \brief find or add a node to the circuit given its label.
-   * \param node_label is label_t
-   * \return unique_ID_t representing the given label
+   * \brief find or add a node to the circuit given its key.
+   * \param node_key is node_key_t
+   * \return unique_ID_t representing the given key
    *
-   *  It searches if the node corresponding to the given label is
+   *  It searches if the node corresponding to the given key is
    *      already inserted into the labels2uuid_table table. If it is,
    *      returns its id. If not, creates a new node into the circuit
    *      and add it to the table.
    *
    */
-  unique_ID_t findOrAddToCircuitByLabel(const label_t& node_label);
+  unique_ID_t findOrAddToCircuitByLabel(node_key_t node_key);
+
+  /**
+   * \brief returns the key of a node in the label tables.
+   * \param label is symbol_t
+   * \param gate_type is GateType
+   * \return node_key_t
+   *
+   *  OUTPUT and FLIP FLOP gates have the same label as another gate. Their
+   *      keys tag the label in the two low bits, all other gates are keyed
+   *      by their label alone.
+   */
+  static node_key_t NodeKey(symbol_t label,
+                            GateType gate_type = GateType::Input);
 
   /* --------------------
    * Conversion functions
@@ -286,12 +297,12 @@ class BenchParser {
   void createCircuitFromOutputList();
 
   /**
-   * \brief create a circuit from the given node's label.
-   * \param bnode_label is label_t
+   * \brief create a circuit from the given node's key.
+   * \param bnode_key is node_key_t
    * \return none
    *
    */
-  void createCircuitByLabel(const label_t& bnode_label);
+  void createCircuitByLabel(node_key_t bnode_key);
 
   /* -----------------------------
    * Topological Sort Algorithms
@@ -347,8 +358,16 @@ class BenchParser {
   /**
    * \brief return a list with the labels of the OUTPUT gates of the circuit.
    * The label's list also includes the FLIP_FLOPS \param none \return
-   * std::set<label_t>
+   * std::vector<symbol_t> sorted by label
+   *
+   */
+  std::vector<symbol_t> GetListOfOutputLabels();
+
+  /**
+   * \brief return the table the labels of the circuit nodes are interned in.
+   * \param none
+   * \return std::shared_ptr<const SymbolTable>
    *
    */
-  std::set<label_t> GetListOfOutputLabels();
+  std::shared_ptr<const SymbolTable> GetSymbols() const;
 };
@@ -0,0 +1,53 @@
+//
+// Interned labels and gate types of bench circuits
+//
+
+#include "BenchSymbols.hpp"
+
+#include <algorithm>
+
+/* Names of the gate types, in the order of the enumeration */
+static const std::string_view gate_names[] = {
+    "INPUT", "OUTPUT", "DFF", "BUFF", "NOT", "AND", "OR", "NAND", "NOR", "XOR"};
+
+std::string_view GateTypeName(GateType type) {
+  return gate_names[static_cast<size_t>(type)];
+}
+
+bool ParseGateType(std::string_view name, GateType &type) {
+  for (size_t i = 0; i < std::size(gate_names); i++) {
+    if (gate_names[i] == name) {
+      type = static_cast<GateType>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+symbol_t SymbolTable::intern(std::string_view name) {
+  auto symbol_it = symbols.find(name);
+  if (symbol_it != symbols.end()) return symbol_it->second;
+
+  auto symbol = static_cast<symbol_t>(names.size());
+  names.emplace_back(name);
+  symbols.emplace(names.back(), symbol);
+  return symbol;
+}
+
+bool SymbolTable::find(std::string_view name, symbol_t &symbol) const {
+  auto symbol_it = symbols.find(name);
+  if (symbol_it == symbols.end()) return false;
+  symbol = symbol_it->second;
+  return true;
+}
+
+const std::string &SymbolTable::name(symbol_t symbol) const {
+  return names.at(symbol);
+}
+
+void SymbolTable::sortByName(std::vector<symbol_t> &labels) const {
+  std::sort(labels.begin(), labels.end(),
+            [this](symbol_t a, symbol_t b) { return names[a] < names[b]; });
+}
+
+size_t SymbolTable::size() const { return names.size(); }
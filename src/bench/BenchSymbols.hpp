@@ -0,0 +1,104 @@
+//
+// Interned labels and gate types of bench circuits
+//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+typedef uint32_t symbol_t;  ///< Dense identifier of an interned label
+
+/**
+ * \enum GateType
+ * \brief Type of a gate in the ISCAS85/89/99 bench format.
+ *
+ */
+enum class GateType : uint8_t {
+  Input,
+  Output,
+  FlipFlop,
+  Buffer,
+  Not,
+  And,
+  Or,
+  Nand,
+  Nor,
+  Xor
+};
+
+/**
+ * \brief Returns the name of a gate type as written in bench files.
+ * \param type is GateType
+ * \return std::string_view
+ */
+std::string_view GateTypeName(GateType type);
+
+/**
+ * \brief Looks up a gate type by the name used in bench files.
+ * \param name is std::string_view, e.g. "NAND" or "DFF"
+ * \param type is GateType and receives the gate type
+ * \return bool false if no gate type has this name
+ */
+bool ParseGateType(std::string_view name, GateType &type);
+
+/**
+ * \class SymbolTable
+ *
+ * \brief Interns the labels of a circuit.
+ *
+ *  Every distinct label is stored once and numbered densely from 0 in the
+ *   order it is first interned, so tables over labels can be indexed by
+ *   symbol instead of hashing strings.
+ *
+ */
+class SymbolTable {
+ public:
+  /**
+   * \brief Returns the symbol of a label, adding it if it is new.
+   * \param name is std::string_view
+   * \return symbol_t
+   */
+  symbol_t intern(std::string_view name);
+
+  /**
+   * \brief Looks up the symbol of a label without adding it.
+   * \param name is std::string_view
+   * \param symbol is symbol_t and receives the symbol
+   * \return bool false if the label was never interned
+   */
+  bool find(std::string_view name, symbol_t &symbol) const;
+
+  /**
+   * \brief Returns the label of a symbol.
+   * \param symbol is symbol_t
+   * \return const std::string&
+   */
+  const std::string &name(symbol_t symbol) const;
+
+  /**
+   * \brief Sorts symbols by their labels.
+   * \param labels is std::vector<symbol_t>
+   * \return none
+   *
+   *  Symbols are numbered in the order labels appear in the file, sorting by
+   *   label gives an order that does not depend on the statement order.
+   */
+  void sortByName(std::vector<symbol_t> &labels) const;
+
+  /**
+   * \brief Returns the number of interned labels.
+   * \param none
+   * \return size_t
+   */
+  size_t size() const;
+
+ private:
+  std::deque<std::string> names;  ///< Label of each symbol, never moved
+  std::unordered_map<std::string_view, symbol_t>
+      symbols;  ///< Symbol of each label, the keys view into names
+};
@@ -0,0 +1,148 @@
+//
+// Single pass tokenizer for ISCAS85/89/99 bench files
+//
+
+#include "BenchTokenizer.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+/* Gate types and the number of inputs they take, 0 for two or more */
+static const std::pair<GateType, size_t> gate_arity[] = {
+    {GateType::Not, 1}, {GateType::Buffer, 1}, {GateType::FlipFlop, 1},
+    {GateType::And, 0}, {GateType::Or, 0},      {GateType::Nand, 0},
+    {GateType::Nor, 0}, {GateType::Xor, 0}};
+
+static bool IsLabelChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '.';
+}
+
+BenchTokenizer::BenchTokenizer(const std::string &bench_file) {
+  int fd = open(bench_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Could not open file: " + bench_file);
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    throw std::runtime_error("Could not read file: " + bench_file);
+  }
+  size = file_stat.st_size;
+
+  /* An empty file cannot be mapped, it simply has no statements */
+  if (size > 0) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Could not map file: " + bench_file);
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(mapping);
+  }
+  close(fd);
+
+  cursor = data;
+  end = data + size;
+}
+
+BenchTokenizer::~BenchTokenizer() {
+  if (data) munmap(const_cast<char *>(data), size);
+}
+
+bool BenchTokenizer::next(bench_format::bench_record_type &record) {
+  skipBlanks(true);
+  if (cursor == end) return false;
+
+  record.line = line;
+  record.inputs.clear();
+  auto first = readLabel();
+  skipBlanks(false);
+
+  if (cursor != end && *cursor == '(') {
+    /* INPUT(label) or OUTPUT(label) */
+    if (!ParseGateType(first, record.gate_type) ||
+        (record.gate_type != GateType::Input &&
+         record.gate_type != GateType::Output)) {
+      fail("unknown statement '" + std::string(first) + "'");
+    }
+    expect('(');
+    record.label = readLabel();
+    expect(')');
+  } else {
+    /* label = GATE(input, ...) */
+    record.label = first;
+    expect('=');
+    skipBlanks(false);
+    auto gate = readLabel();
+    if (!ParseGateType(gate, record.gate_type)) {
+      fail("unknown gate '" + std::string(gate) + "'");
+    }
+    expect('(');
+    record.inputs.push_back(readLabel());
+    skipBlanks(false);
+    while (cursor != end && *cursor == ',') {
+      cursor++;
+      record.inputs.push_back(readLabel());
+      skipBlanks(false);
+    }
+    expect(')');
+
+    size_t arity = SIZE_MAX;
+    for (const auto &[type, inputs] : gate_arity) {
+      if (type == record.gate_type) arity = inputs;
+    }
+    if (arity == SIZE_MAX) {
+      fail(std::string(gate) + " is not a gate");
+    }
+    if (arity ? record.inputs.size() != arity : record.inputs.size() < 2) {
+      fail("wrong number of inputs to " + std::string(gate));
+    }
+  }
+
+  /* A statement ends with its line */
+  skipBlanks(false);
+  if (cursor != end && *cursor != '\n' && *cursor != '\r' && *cursor != '#') {
+    fail("unexpected '" + std::string(1, *cursor) + "'");
+  }
+  return true;
+}
+
+void BenchTokenizer::skipBlanks(bool lines) {
+  while (cursor != end) {
+    char c = *cursor;
+    if (c == ' ' || c == '\t') {
+      cursor++;
+    } else if (lines && (c == '\n' || c == '\r')) {
+      if (c == '\n') line++;
+      cursor++;
+    } else if (lines && c == '#') {
+      while (cursor != end && *cursor != '\n') cursor++;
+    } else {
+      return;
+    }
+  }
+}
+
+std::string_view BenchTokenizer::readLabel() {
+  skipBlanks(false);
+  auto first = cursor;
+  while (cursor != end && IsLabelChar(*cursor)) cursor++;
+  if (cursor == first) fail("expected a label");
+  return std::string_view(first, cursor - first);
+}
+
+void BenchTokenizer::expect(char c) {
+  skipBlanks(false);
+  if (cursor == end || *cursor != c) fail(std::string("expected '") + c + "'");
+  cursor++;
+}
+
+void BenchTokenizer::fail(const std::string &what) const {
+  throw std::runtime_error("Line " + std::to_string(line) + ": " + what);
+}
@@ -0,0 +1,103 @@
+//
+// Single pass tokenizer for ISCAS85/89/99 bench files
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BenchSymbols.hpp"
+
+namespace bench_format {
+
+/**
+ * \struct bench_node_type
+ * \brief One statement of a bench file with interned labels.
+ *
+ */
+struct bench_node_type {
+  symbol_t label;      // Unique ID for a node
+  GateType gate_type;  // Type of the gate (ex. AND, NOT, OR)
+  std::vector<symbol_t>
+      input_node_list;  // list containing all the inputs of the respective gate
+};
+
+/**
+ * \struct bench_record_type
+ * \brief One statement of a bench file as views into the mapped file.
+ *
+ *  INPUT and OUTPUT statements have no inputs, their label is the signal
+ *   they declare.
+ */
+struct bench_record_type {
+  std::string_view label;
+  GateType gate_type;
+  std::vector<std::string_view> inputs;
+  size_t line;  ///< Line of the statement, starting at 1
+};
+
+}  // namespace bench_format
+
+/**
+ * \class BenchTokenizer
+ *
+ * \brief Reads the statements of a bench file in a single pass.
+ *
+ *  The file is mapped into memory and never copied: labels are returned as
+ *   std::string_view into the mapping, so they stay valid while the
+ *   tokenizer exists. Blanks, empty lines and comments starting with '#' are
+ *   skipped.
+ *
+ */
+class BenchTokenizer {
+ public:
+  /**
+   * \brief Maps the file into memory.
+   * \param bench_file is std::string
+   *
+   *  Throws std::runtime_error if the file cannot be opened or mapped.
+   */
+  explicit BenchTokenizer(const std::string &bench_file);
+
+  ~BenchTokenizer();
+
+  BenchTokenizer(const BenchTokenizer &) = delete;
+  BenchTokenizer &operator=(const BenchTokenizer &) = delete;
+
+  /**
+   * \brief Reads the next statement.
+   * \param record is bench_record_type and receives the statement
+   * \return bool false once the end of the file is reached
+   *
+   *  Throws std::runtime_error with the line number if the statement is not
+   *   valid bench syntax.
+   */
+  bool next(bench_format::bench_record_type &record);
+
+ private:
+  /**
+   * \brief Skips blanks, and newlines and comments if lines is set.
+   */
+  void skipBlanks(bool lines);
+
+  /**
+   * \brief Reads a label made of letters, digits, '_' and '.'.
+   */
+  std::string_view readLabel();
+
+  /**
+   * \brief Consumes the given character or throws.
+   */
+  void expect(char c);
+
+  [[noreturn]] void fail(const std::string &what) const;
+
+  const char *data = nullptr;
+  size_t size = 0;
+  const char *cursor = nullptr;
+  const char *end = nullptr;
+  size_t line = 1;
+};
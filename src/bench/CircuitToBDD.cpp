@@ -5,19 +5,21 @@
 
 #include "CircuitToBDD.hpp"
 
+#include <spdlog/spdlog.h>
+
 #include <utility>
 
 CircuitToBDD::CircuitToBDD(
-    shared_ptr<ClassProject::ManagerInterface> BDD_manager_p) {
+    shared_ptr<ClassProject::ManagerInterface> BDD_manager_p,
+    std::shared_ptr<const SymbolTable> symbols_p) {
   bdd_manager = std::move(BDD_manager_p);
+  symbols = std::move(symbols_p);
 }
 
 CircuitToBDD::~CircuitToBDD() = default;
 
 void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit,
                                const std::string &benchmark_file) {
-  ClassProject::BDD_ID BDD_node;
-
   std::filesystem::path pathToBenchFile(benchmark_file);
   if (!pathToBenchFile.has_filename())
     throw std::runtime_error(
@@ -41,46 +43,112 @@ void CircuitToBDD::GenerateBDD(const list_of_circuit_t &circuit,
 
   bdd_out_file << "BDD_ID,Bench Label" << std::endl;
 
+  std::ofstream timeline_file;
+  if (timeline) {
+    timeline_file.open(result_dir + "/timeline.csv");
+    if (!timeline_file.is_open()) {
+      throw std::runtime_error("Unable to open Timeline File!");
+    }
+    timeline_file << "Bench Label,Gate Type,Unique Table Size,Unique Hits,"
+                     "Computed Hits"
+                  << std::endl;
+  }
+
+  label_to_bdd_id.assign(symbols->size(), NO_BDD_ID);
+
   // Store cursor position
   std::cout << "\033[s" << std::flush;
 
   for (const auto &circuit_node : circuit) {
-    // std::cout << "\033[u" << circuit_node.id << " - " << circuit_node.label
-    //           << " (" << bdd_manager->uniqueTableSize() << ", "
-    //           << bdd_manager->ucache_hits() << ", "
-    //           << bdd_manager->pcache_hits() << ")" << std::flush;
-    if (circuit_node.gate_type == INPUT_GATE_T) {
+    ClassProject::BDD_ID BDD_node = BuildGate(circuit_node);
+    if (BDD_node == NO_BDD_ID) continue;
+
+    const auto &label = symbols->name(circuit_node.label);
+    bdd_out_file << BDD_node << "," << label << std::endl;
+
+    if (timeline) {
+      timeline_file << label << "," << GateTypeName(circuit_node.gate_type)
+                    << "," << bdd_manager->uniqueTableSize() << ","
+                    << bdd_manager->ucache_hits() << ","
+                    << bdd_manager->pcache_hits() << "\n";
+    }
+  }
+
+  std::cout << "\033[u" << std::flush;
+
+  bdd_out_file.close();
+}
+
+void CircuitToBDD::BuildBDD(const list_of_circuit_t &circuit) {
+  label_to_bdd_id.assign(symbols->size(), NO_BDD_ID);
+  for (const auto &circuit_node : circuit) BuildGate(circuit_node);
+}
+
+ClassProject::BDD_ID CircuitToBDD::BuildGate(
+    const circuit_node_t &circuit_node) {
+  ClassProject::BDD_ID BDD_node = NO_BDD_ID;
+
+  spdlog::debug("{} - {} ({}, {}, {})", circuit_node.id,
+                symbols->name(circuit_node.label),
+                bdd_manager->uniqueTableSize(), bdd_manager->ucache_hits(),
+                bdd_manager->pcache_hits());
+  switch (circuit_node.gate_type) {
+    case GateType::Input:
       BDD_node = InputGate(circuit_node.label);
-    } else if (circuit_node.gate_type == NOT_GATE_T) {
+      break;
+    case GateType::Not:
       BDD_node = NotGate(circuit_node.input_id_list);
-    } else if (circuit_node.gate_type == AND_GATE_T) {
+      break;
+    case GateType::And:
       BDD_node = AndGate(circuit_node.input_id_list);
-    } else if (circuit_node.gate_type == OR_GATE_T) {
+      break;
+    case GateType::Or:
       BDD_node = OrGate(circuit_node.input_id_list);
-    } else if (circuit_node.gate_type == NAND_GATE_T) {
+      break;
+    case GateType::Nand:
       BDD_node = NandGate(circuit_node.input_id_list);
-    } else if (circuit_node.gate_type == NOR_GATE_T) {
+      break;
+    case GateType::Nor:
       BDD_node = NorGate(circuit_node.input_id_list);
-    } else if (circuit_node.gate_type == XOR_GATE_T) {
+      break;
+    case GateType::Xor:
       BDD_node = XorGate(circuit_node.input_id_list);
-    } else if (circuit_node.gate_type == BUFFER_GATE_T) {
+      break;
+    case GateType::Buffer:
       BDD_node = findBddId(*circuit_node.input_id_list.begin());
-    }
+      break;
+    case GateType::Output:
+    case GateType::FlipFlop:
+      /* OUTPUT or FLIP FLOP gates do not generate a BDD */
+      return NO_BDD_ID;
+    default:
+      throw std::runtime_error("Unknown gate type of node: " +
+                               symbols->name(circuit_node.label));
+  }
 
-    /* OUTPUT or FLIP FLOP gates do not generate a BDD */
-    if (!((circuit_node.gate_type == OUTPUT_GATE_T) |
-          (circuit_node.gate_type == FLIP_FLOP_GATE_T))) {
-      node_to_bdd_id.insert(std::pair<unique_ID_t, ClassProject::BDD_ID>(
-          circuit_node.id, BDD_node));
-      label_to_bdd_id.insert(std::pair<label_t, ClassProject::BDD_ID>(
-          circuit_node.label, BDD_node));
-      bdd_out_file << BDD_node << "," << circuit_node.label << std::endl;
-    }
+  node_to_bdd_id.insert(std::pair<unique_ID_t, ClassProject::BDD_ID>(
+      circuit_node.id, BDD_node));
+  if (label_to_bdd_id[circuit_node.label] == NO_BDD_ID) {
+    label_to_bdd_id[circuit_node.label] = BDD_node;
   }
+  return BDD_node;
+}
 
-  std::cout << "\033[u" << std::flush;
+void CircuitToBDD::EnableTimeline(bool enable) { timeline = enable; }
 
-  bdd_out_file.close();
+const std::string &CircuitToBDD::GetResultDir() const { return result_dir; }
+
+void CircuitToBDD::BindInput(symbol_t label, ClassProject::BDD_ID var) {
+  bound_inputs[label] = var;
+}
+
+ClassProject::BDD_ID CircuitToBDD::GetBddId(symbol_t label) const {
+  if (label < label_to_bdd_id.size() && label_to_bdd_id[label] != NO_BDD_ID) {
+    return label_to_bdd_id[label];
+  } else {
+    throw std::runtime_error("No BDD was generated for label: " +
+                             symbols->name(label));
+  }
 }
 
 ClassProject::BDD_ID CircuitToBDD::findBddId(unique_ID_t circuit_node) {
@@ -94,8 +162,12 @@ ClassProject::BDD_ID CircuitToBDD::findBddId(unique_ID_t circuit_node) {
   }
 }
 
-ClassProject::BDD_ID CircuitToBDD::InputGate(const label_t &label) {
-  return bdd_manager->createVar(label);
+ClassProject::BDD_ID CircuitToBDD::InputGate(symbol_t label) {
+  auto bound_it = bound_inputs.find(label);
+  if (bound_it != bound_inputs.end()) {
+    return bound_it->second;
+  }
+  return bdd_manager->createVar(symbols->name(label));
 }
 
 ClassProject::BDD_ID CircuitToBDD::NotGate(const set_of_circuit_t &inputNodes) {
@@ -103,121 +175,43 @@ ClassProject::BDD_ID CircuitToBDD::NotGate(const set_of_circuit_t &inputNodes) {
   return bdd_manager->neg(findBddId(node));
 }
 
-ClassProject::BDD_ID CircuitToBDD::AndGate(set_of_circuit_t inputNodes) {
-  auto it = inputNodes.begin();
-  ClassProject::BDD_ID first_op, second_op;
-
-  /* Get the ClassProject::BDD_ID of first elements */
-  first_op = findBddId(*it);
-  inputNodes.erase(it);
-
-  while (!inputNodes.empty()) {
-    it = inputNodes.begin();
-    second_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    first_op = bdd_manager->and2(first_op, second_op);
+std::vector<ClassProject::BDD_ID> CircuitToBDD::findBddIds(
+    const set_of_circuit_t &inputNodes) {
+  std::vector<ClassProject::BDD_ID> operands;
+  operands.reserve(inputNodes.size());
+  for (const auto &input_node : inputNodes) {
+    operands.push_back(findBddId(input_node));
   }
+  return operands;
+}
 
+ClassProject::BDD_ID CircuitToBDD::AndGate(const set_of_circuit_t &inputNodes) {
   /* Return the ClassProject::BDD_ID equivalent to the AND of all inputs */
-  return first_op;
+  return bdd_manager->andN(findBddIds(inputNodes));
 }
 
-ClassProject::BDD_ID CircuitToBDD::OrGate(set_of_circuit_t inputNodes) {
-  auto it = inputNodes.begin();
-  ClassProject::BDD_ID first_op, second_op;
-
-  /* Get the ClassProject::BDD_ID of first elements */
-  first_op = findBddId(*it);
-  inputNodes.erase(it);
-
-  while (!inputNodes.empty()) {
-    it = inputNodes.begin();
-    second_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    first_op = bdd_manager->or2(first_op, second_op);
-  }
-
+ClassProject::BDD_ID CircuitToBDD::OrGate(const set_of_circuit_t &inputNodes) {
   /* Return the ClassProject::BDD_ID equivalent to the OR of all inputs */
-  return first_op;
+  return bdd_manager->orN(findBddIds(inputNodes));
 }
 
-ClassProject::BDD_ID CircuitToBDD::NandGate(set_of_circuit_t inputNodes) {
-  auto it = inputNodes.begin();
-  ClassProject::BDD_ID first_op, second_op;
-
-  /* Get the ClassProject::BDD_ID of first elements */
-  it = inputNodes.begin();
-  first_op = findBddId(*it);
-  inputNodes.erase(it);
-
-  if (inputNodes.size() == 1) {
-    it = inputNodes.begin();
-    second_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    /* Create the NAND BDD node for the first two elements */
-    first_op = bdd_manager->nand2(first_op, second_op);
-  } else {
-    /* AND of all inputs, to use as the second operator of the NAND gate */
-    second_op = AndGate(inputNodes);
-    /* Create the NAND BDD node */
-    first_op = bdd_manager->nand2(first_op, second_op);
-  }
-
+ClassProject::BDD_ID CircuitToBDD::NandGate(
+    const set_of_circuit_t &inputNodes) {
   /* Return the ClassProject::BDD_ID equivalent to the NAND of all inputs */
-  return first_op;
+  return bdd_manager->neg(AndGate(inputNodes));
 }
 
-ClassProject::BDD_ID CircuitToBDD::NorGate(set_of_circuit_t inputNodes) {
-  auto it = inputNodes.begin();
-  ClassProject::BDD_ID first_op, second_op;
-
-  /* Get the ClassProject::BDD_ID of first elements */
-  it = inputNodes.begin();
-  first_op = findBddId(*it);
-  inputNodes.erase(it);
-
-  if (inputNodes.size() == 1) {
-    it = inputNodes.begin();
-    second_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    /* Create the NOR BDD node for the first two elements */
-    first_op = bdd_manager->nor2(first_op, second_op);
-  } else {
-    /* OR of all inputs, to use as the second operator of the NAND gate */
-    second_op = OrGate(inputNodes);
-    /* Create the NOR BDD node */
-    first_op = bdd_manager->nor2(first_op, second_op);
-  }
-
+ClassProject::BDD_ID CircuitToBDD::NorGate(const set_of_circuit_t &inputNodes) {
   /* Return the ClassProject::BDD_ID equivalent to the NOR of all inputs */
-  return first_op;
+  return bdd_manager->neg(OrGate(inputNodes));
 }
 
-ClassProject::BDD_ID CircuitToBDD::XorGate(set_of_circuit_t inputNodes) {
-  auto it = inputNodes.begin();
-  ClassProject::BDD_ID first_op, second_op;
-
-  /* Get the ClassProject::BDD_ID of first elements */
-  first_op = findBddId(*it);
-  inputNodes.erase(it);
-
-  while (!inputNodes.empty()) {
-    it = inputNodes.begin();
-    second_op = findBddId(*it);
-    inputNodes.erase(it);
-
-    first_op = bdd_manager->xor2(first_op, second_op);
-  }
-
+ClassProject::BDD_ID CircuitToBDD::XorGate(const set_of_circuit_t &inputNodes) {
   /* Return the ClassProject::BDD_ID equivalent to the XOR of all inputs */
-  return first_op;
+  return bdd_manager->xorN(findBddIds(inputNodes));
 }
 
-void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
+void CircuitToBDD::PrintBDD(const std::vector<symbol_t> &output_labels) {
   if ((!(std::filesystem::exists(result_dir + "/txt")) &
        !(std::filesystem::create_directory(result_dir + "/txt"))) &
       (!(std::filesystem::exists(result_dir + "/dot")) &
@@ -227,13 +221,11 @@ void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
   }
 
   for (const auto &output_label : output_labels) {
-    auto output_id_it = label_to_bdd_id.find(output_label);
-
-    if (output_id_it != label_to_bdd_id.end()) {
-      std::string dot_file_name =
-          result_dir + "/dot/" + std::string(output_label) + ".dot";
-      std::string txt_file_name =
-          result_dir + "/txt/" + std::string(output_label) + ".txt";
+    if (output_label < label_to_bdd_id.size() &&
+        label_to_bdd_id[output_label] != NO_BDD_ID) {
+      const auto &label = symbols->name(output_label);
+      std::string dot_file_name = result_dir + "/dot/" + label + ".dot";
+      std::string txt_file_name = result_dir + "/txt/" + label + ".txt";
 
       std::ofstream bdd_out_dot_file(dot_file_name);
       std::ofstream bdd_out_txt_file(txt_file_name);
@@ -244,8 +236,8 @@ void CircuitToBDD::PrintBDD(const std::set<label_t> &output_labels) {
 
       output_nodes.clear();
       output_vars.clear();
-      bdd_manager->findNodes(output_id_it->second, output_nodes);
-      bdd_manager->findVars(output_id_it->second, output_vars);
+      bdd_manager->findNodes(label_to_bdd_id[output_label], output_nodes);
+      bdd_manager->findVars(label_to_bdd_id[output_label], output_vars);
 
       dumpBddText(bdd_out_txt_file);
       dumpBddDot(bdd_out_dot_file);
@@ -8,6 +8,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 #include "../ManagerInterface.h"
 #include "BenchParser.hpp"
@@ -24,8 +25,13 @@
  */
 class CircuitToBDD {
  public:
-  explicit CircuitToBDD(
-      shared_ptr<ClassProject::ManagerInterface> BDD_manager_p);
+  /**
+   * \brief Constructor
+   * \param BDD_manager_p is the manager to build the BDDs in
+   * \param symbols_p is the table the labels of the circuit are interned in
+   */
+  CircuitToBDD(shared_ptr<ClassProject::ManagerInterface> BDD_manager_p,
+               std::shared_ptr<const SymbolTable> symbols_p);
   ~CircuitToBDD();
 
   /**
@@ -39,21 +45,76 @@ class CircuitToBDD {
   void GenerateBDD(const std::list<circuit_node_t> &circuit,
                    const std::string &benchmark_file);
 
+  /**
+   * \brief Builds the BDDs of the circuit nodes without writing any results
+   * \param Topologically sorted list containing the circuit nodes
+   * \return none
+   *
+   *  Like GenerateBDD, but neither creates the result directory nor prints
+   *   progress, for loading circuits as a library.
+   */
+  void BuildBDD(const std::list<circuit_node_t> &circuit);
+
   /**
    * \brief Print the generated BDD in text and dot format
    * \param The set of output labels to print a BDD for
    * \return none
    */
-  void PrintBDD(const std::set<label_t> &output_labels);
+  void PrintBDD(const std::vector<symbol_t> &output_labels);
+
+  /**
+   * \brief Enable the per-gate timeline written by GenerateBDD
+   * \param enable is bool
+   * \return none
+   *
+   *  When enabled, GenerateBDD writes timeline.csv to the result directory
+   *   with one row per gate: label, gate type, unique table size and the
+   *   unique/computed table hit counters after the gate was built.
+   */
+  void EnableTimeline(bool enable = true);
+
+  /**
+   * \brief Use an existing variable for an INPUT gate
+   * \param label is symbol_t
+   * \param var is ClassProject::BDD_ID
+   * \return none
+   *
+   *  GenerateBDD uses var for the INPUT gate with this label instead of
+   *   creating a new variable, e.g. to map flip-flops and primary inputs to
+   *   the variables of a state machine.
+   */
+  void BindInput(symbol_t label, ClassProject::BDD_ID var);
+
+  /**
+   * \brief Returns the BDD_ID generated for the node with the given label
+   * \param label is symbol_t
+   * \return ClassProject::BDD_ID
+   *
+   */
+  ClassProject::BDD_ID GetBddId(symbol_t label) const;
+
+  /**
+   * \brief Returns the directory the results of GenerateBDD are stored in
+   * \param none
+   * \return std::string
+   */
+  const std::string &GetResultDir() const;
 
  private:
   std::unordered_map<unique_ID_t, ClassProject::BDD_ID>
       node_to_bdd_id;  ///< Mapping from circuit node's unique ID to its BDD ID
-  std::unordered_map<label_t, ClassProject::BDD_ID>
-      label_to_bdd_id;  ///< Mapping from node's label to its BDD ID
+  std::vector<ClassProject::BDD_ID>
+      label_to_bdd_id;  ///< BDD ID of each label, NO_BDD_ID if none was built
+  std::unordered_map<symbol_t, ClassProject::BDD_ID>
+      bound_inputs;  ///< Variables to use for INPUT gates, by label
+
+  static constexpr ClassProject::BDD_ID NO_BDD_ID =
+      std::numeric_limits<ClassProject::BDD_ID>::max();
 
   shared_ptr<ClassProject::ManagerInterface> bdd_manager{};
+  std::shared_ptr<const SymbolTable> symbols;  ///< Labels of the circuit
   std::string result_dir;  ///< Directory where the results are stored
+  bool timeline = false;   ///< Write the per-gate timeline in GenerateBDD
 
   std::set<ClassProject::BDD_ID> output_nodes;
   std::set<ClassProject::BDD_ID> output_vars;
@@ -66,13 +127,30 @@ class CircuitToBDD {
    */
   ClassProject::BDD_ID findBddId(unique_ID_t circuit_node);
 
+  /**
+   * \brief Returns the BDD_IDs of the given circuit IDs
+   * \param inputNodes is set_of_circuit_t
+   * \return std::vector<ClassProject::BDD_ID>
+   *
+   */
+  std::vector<ClassProject::BDD_ID> findBddIds(
+      const set_of_circuit_t &inputNodes);
+
+  /**
+   * \brief Builds the BDD of one circuit node and records it
+   * \param circuit_node is circuit_node_t
+   * \return ClassProject::BDD_ID, NO_BDD_ID for OUTPUT and FLIP FLOP gates
+   *
+   */
+  ClassProject::BDD_ID BuildGate(const circuit_node_t &circuit_node);
+
   /**
    * \brief Generates the BDD node equivalent to a variable with label "label".
-   * \param label is label_t
+   * \param label is symbol_t
    * \return ClassProject::BDD_ID
    *
    */
-  ClassProject::BDD_ID InputGate(const label_t &label);
+  ClassProject::BDD_ID InputGate(symbol_t label);
 
   /**
    * \brief Generates the BDD node equivalent to the NOT gate.
@@ -88,7 +166,7 @@ class CircuitToBDD {
    * be used as input. \return ClassProject::BDD_ID
    *
    */
-  ClassProject::BDD_ID AndGate(set_of_circuit_t inputNodes);
+  ClassProject::BDD_ID AndGate(const set_of_circuit_t &inputNodes);
 
   /**
    * \brief Generates the BDD node equivalent to the OR gate.
@@ -96,7 +174,7 @@ class CircuitToBDD {
    * be used as input. \return ClassProject::BDD_ID
    *
    */
-  ClassProject::BDD_ID OrGate(set_of_circuit_t inputNodes);
+  ClassProject::BDD_ID OrGate(const set_of_circuit_t &inputNodes);
 
   /**
    * \brief Generates the BDD node equivalent to the NAND gate.
@@ -104,7 +182,7 @@ class CircuitToBDD {
    * be used as input. \return ClassProject::BDD_ID
    *
    */
-  ClassProject::BDD_ID NandGate(set_of_circuit_t inputNodes);
+  ClassProject::BDD_ID NandGate(const set_of_circuit_t &inputNodes);
 
   /**
    * \brief Generates the BDD node equivalent to the NOR gate.
@@ -112,7 +190,7 @@ class CircuitToBDD {
    * be used as input. \return ClassProject::BDD_ID
    *
    */
-  ClassProject::BDD_ID NorGate(set_of_circuit_t inputNodes);
+  ClassProject::BDD_ID NorGate(const set_of_circuit_t &inputNodes);
 
   /**
    * \brief Generates the BDD node equivalent to the XOR gate.
@@ -120,7 +198,7 @@ class CircuitToBDD {
    * be used as input. \return ClassProject::BDD_ID
    *
    */
-  ClassProject::BDD_ID XorGate(set_of_circuit_t inputNodes);
+  ClassProject::BDD_ID XorGate(const set_of_circuit_t &inputNodes);
 
   void dumpBddText(std::ostream &out);
 
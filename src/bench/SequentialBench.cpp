@@ -0,0 +1,129 @@
+//
+// Loads sequential ISCAS89 circuits into a state machine
+//
+
+#include "SequentialBench.hpp"
+
+#include <set>
+#include <unordered_map>
+
+#include "CircuitToBDD.hpp"
+
+/**
+ * \brief Number of state bits to place before each input.
+ * \return std::vector<unsigned int>
+ *
+ *  Walks the D cones of the flip-flops in state bit order. An input is first
+ *   met in the cone of the lowest state bit reading it, nodes already visited
+ *   only lead to inputs that were placed before.
+ */
+static std::vector<unsigned int> PlaceInputsNearFanout(
+    const list_of_circuit_t &circuit, const std::vector<unique_ID_t> &d_inputs,
+    const std::vector<symbol_t> &input_labels) {
+  std::unordered_map<unique_ID_t, const circuit_node_t *> id_to_node;
+  for (const auto &circuit_node : circuit) {
+    id_to_node[circuit_node.id] = &circuit_node;
+  }
+
+  std::unordered_map<symbol_t, unsigned int> first_reader;
+  std::set<unique_ID_t> visited;
+  unsigned int state_bit = 0;
+  for (auto d_input : d_inputs) {
+    std::vector<unique_ID_t> pending = {d_input};
+    while (!pending.empty()) {
+      auto id = pending.back();
+      pending.pop_back();
+      if (!visited.insert(id).second) continue;
+
+      const auto *circuit_node = id_to_node.at(id);
+      if (circuit_node->gate_type == GateType::Input) {
+        first_reader.emplace(circuit_node->label, state_bit);
+      }
+      pending.insert(pending.end(), circuit_node->input_id_list.begin(),
+                     circuit_node->input_id_list.end());
+    }
+    state_bit++;
+  }
+
+  /* Inputs no flip-flop reads go last */
+  std::vector<unsigned int> positions;
+  for (const auto &input : input_labels) {
+    auto reader = first_reader.find(input);
+    positions.push_back(reader != first_reader.end() ? reader->second
+                                                     : d_inputs.size());
+  }
+  return positions;
+}
+
+SequentialCircuit LoadSequentialBench(const std::string &bench_file,
+                                      InputOrder input_order) {
+  BenchParser parsed_circuit(bench_file);
+  auto circuit = parsed_circuit.GetSortedCircuit();
+  auto symbols = parsed_circuit.GetSymbols();
+
+  /* A flip-flop is split into a DFF gate driven by its D input and an INPUT
+   * gate with the same label that drives the logic */
+  std::unordered_map<unique_ID_t, symbol_t> id_to_label;
+  std::unordered_map<symbol_t, unique_ID_t> ff_to_input;
+  std::set<symbol_t> inputs;
+  for (const auto &circuit_node : circuit) {
+    id_to_label[circuit_node.id] = circuit_node.label;
+    if (circuit_node.gate_type == GateType::FlipFlop) {
+      ff_to_input[circuit_node.label] = *circuit_node.input_id_list.begin();
+    } else if (circuit_node.gate_type == GateType::Input) {
+      inputs.insert(circuit_node.label);
+    }
+  }
+  for (const auto &ff : ff_to_input) inputs.erase(ff.first);
+
+  if (ff_to_input.empty()) {
+    throw std::runtime_error("No flip-flops in " + bench_file);
+  }
+
+  /* State and input bits are numbered by label */
+  std::vector<symbol_t> state_symbols, input_symbols(inputs.begin(),
+                                                     inputs.end());
+  for (const auto &ff : ff_to_input) state_symbols.push_back(ff.first);
+  symbols->sortByName(state_symbols);
+  symbols->sortByName(input_symbols);
+
+  SequentialCircuit sequential;
+  std::vector<unique_ID_t> d_inputs;
+  for (auto state : state_symbols) {
+    sequential.state_labels.push_back(symbols->name(state));
+    d_inputs.push_back(ff_to_input.at(state));
+  }
+  for (auto input : input_symbols) {
+    sequential.input_labels.push_back(symbols->name(input));
+  }
+
+  ClassProject::OrderingPolicy policy;
+  if (input_order == InputOrder::First) {
+    policy.order = ClassProject::VariableOrder::InputsFirst;
+  } else if (input_order == InputOrder::NearFanout) {
+    policy.order = ClassProject::VariableOrder::Custom;
+    policy.input_positions =
+        PlaceInputsNearFanout(circuit, d_inputs, input_symbols);
+  }
+  sequential.fsm = std::make_shared<ClassProject::Reachability>(
+      state_symbols.size(), input_symbols.size(), policy);
+
+  /* Build the logic over the variables of the state machine */
+  CircuitToBDD circuit2BDD(sequential.fsm, symbols);
+  for (size_t i = 0; i < state_symbols.size(); i++) {
+    circuit2BDD.BindInput(state_symbols[i], sequential.fsm->getStates()[i]);
+  }
+  for (size_t i = 0; i < input_symbols.size(); i++) {
+    circuit2BDD.BindInput(input_symbols[i], sequential.fsm->getInputs()[i]);
+  }
+  circuit2BDD.BuildBDD(circuit);
+
+  std::vector<ClassProject::BDD_ID> transition_functions;
+  for (auto d_input : d_inputs) {
+    transition_functions.push_back(
+        circuit2BDD.GetBddId(id_to_label.at(d_input)));
+  }
+  sequential.fsm->setTransitionFunctions(transition_functions);
+
+  return sequential;
+}
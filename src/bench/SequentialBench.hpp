@@ -0,0 +1,49 @@
+//
+// Loads sequential ISCAS89 circuits into a state machine
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../reachability/Reachability.h"
+#include "BenchParser.hpp"
+
+/**
+ * \struct SequentialCircuit
+ * \brief State machine built from a sequential bench file.
+ *
+ */
+struct SequentialCircuit {
+  std::shared_ptr<ClassProject::Reachability> fsm;  ///< The state machine
+  std::vector<label_t> state_labels;  ///< Flip-flop label of each state bit
+  std::vector<label_t> input_labels;  ///< Primary input of each input bit
+};
+
+/**
+ * \enum InputOrder
+ * \brief Where LoadSequentialBench places the inputs in the variable order.
+ *
+ */
+enum class InputOrder {
+  Last,       ///< After all state bits
+  First,      ///< Before all state bits
+  NearFanout  ///< Right before the first state bit whose D cone reads it
+};
+
+/**
+ * \brief Builds a state machine from a sequential bench file.
+ * \param bench_file is std::string
+ * \param input_order is InputOrder
+ * \return SequentialCircuit
+ *
+ *  Every DFF gate becomes a state bit and the BDD of its D input becomes the
+ *   transition function of that bit. All other INPUT gates become the inputs
+ *   of the state machine. State and input bits are numbered by label, the
+ *   initial state has all flip-flops reset.
+ */
+SequentialCircuit LoadSequentialBench(
+    const std::string &bench_file,
+    InputOrder input_order = InputOrder::NearFanout);
@@ -6,6 +6,7 @@
 #include <spdlog/cfg/env.h>
 #include <spdlog/spdlog.h>
 
+#include <fstream>
 #include <iostream>
 #include <string>
 
@@ -31,15 +32,24 @@ int main(int argc, char *argv[]) {
 
   std::string bench_file = argv[1];
 #endif
+  /* Optional path to write the manager statistics to as JSON, also enables
+   * the per-gate timeline */
+  std::string stats_file = argc > 2 ? argv[2] : "";
+  /* Optional path to record a journal of all manager operations to */
+  std::string journal_file = argc > 3 ? argv[3] : "";
 
   /* Parse the circuit from file and generate topological sorted circuit */
   BenchParser parsed_circuit(bench_file);
 
   std::cout << "- Initializating BDD manager... ";
   auto BDD_manager = make_shared<ClassProject::Manager>();
+  BDD_manager->enableStats(!stats_file.empty());
+  if (!journal_file.empty()) BDD_manager->startJournal(journal_file);
   std::cout << "Done!" << std::endl;
   std::cout << "- Initializating circuit to BDD converter... ";
-  auto circuit2BDD = make_unique<CircuitToBDD>(BDD_manager);
+  auto circuit2BDD =
+      make_unique<CircuitToBDD>(BDD_manager, parsed_circuit.GetSymbols());
+  circuit2BDD->EnableTimeline(!stats_file.empty());
   std::cout << "Done!" << std::endl;
 
   double user_time, vm1, rss1, vm2, rss2;
@@ -57,10 +67,25 @@ int main(int argc, char *argv[]) {
 
   circuit2BDD->PrintBDD(parsed_circuit.GetListOfOutputLabels());
 
+  /* Nodes per variable, to spot the variables that cause blowup */
+  std::ofstream levels_file(circuit2BDD->GetResultDir() + "/levels.csv");
+  levels_file << "Variable,Label,Nodes" << std::endl;
+  for (const auto &[var, count] : BDD_manager->levelHistogram()) {
+    levels_file << var << "," << BDD_manager->getTopVarName(var) << ","
+                << count << "\n";
+  }
+  levels_file.close();
+
   std::cout << "**** Performance ****" << std::endl;
   std::cout << " Runtime: " << user_time << std::endl;
   process_mem_usage(vm2, rss2);
   std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << endl << endl;
 
+  if (!stats_file.empty()) {
+    std::ofstream stats_out(stats_file);
+    stats_out << BDD_manager->stats().toJson();
+    std::cout << " Statistics written to " << stats_file << endl;
+  }
+
   return 0;
 }
@@ -0,0 +1,96 @@
+//
+// Reachability analysis of sequential ISCAS89 circuits
+//
+
+#include <spdlog/cfg/env.h>
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "BenchmarkLib.h"
+#include "SequentialBench.hpp"
+
+int main(int argc, char *argv[]) {
+  spdlog::cfg::load_env_levels();
+
+  if (2 > argc) {
+    std::cout << "Usage: " << argv[0]
+              << " <bench> [relation|functions|squaring] [fanout|first|last]"
+                 " [telemetry.json|telemetry.csv]"
+              << std::endl;
+    return -1;
+  }
+
+  std::string bench_file = argv[1];
+  std::string mode = argc > 2 ? argv[2] : "relation";
+  if (mode != "relation" && mode != "functions" && mode != "squaring") {
+    std::cout << "Unknown mode: " << mode << std::endl;
+    return -1;
+  }
+
+  /* Placement of the inputs in the variable order */
+  std::string order = argc > 3 ? argv[3] : "fanout";
+  InputOrder input_order;
+  if (order == "fanout") {
+    input_order = InputOrder::NearFanout;
+  } else if (order == "first") {
+    input_order = InputOrder::First;
+  } else if (order == "last") {
+    input_order = InputOrder::Last;
+  } else {
+    std::cout << "Unknown order: " << order << std::endl;
+    return -1;
+  }
+
+  /* Optional path to write the per-iteration telemetry to, CSV if it ends
+   * with .csv and JSON otherwise */
+  std::string telemetry_file = argc > 4 ? argv[4] : "";
+
+  double load_time, reach_time, vm1, rss1, vm2, rss2;
+  process_mem_usage(vm1, rss1);
+
+  load_time = userTime();
+  auto circuit = LoadSequentialBench(bench_file, input_order);
+  auto &fsm = *circuit.fsm;
+  if (mode == "functions") {
+    fsm.setImageEngine(ClassProject::ImageEngine::Functions);
+  }
+  fsm.setIterativeSquaring(mode == "squaring");
+  fsm.recordTelemetry(!telemetry_file.empty());
+  load_time = userTime() - load_time;
+
+  reach_time = userTime();
+  auto reachable = fsm.reachableStates();
+  reach_time = userTime() - reach_time;
+
+  std::cout << "**** Reachability ****" << std::endl;
+  std::cout << " State bits: " << fsm.getStates().size() << std::endl;
+  std::cout << " Inputs: " << fsm.getInputs().size() << std::endl;
+  std::cout << " Mode: " << mode << std::endl;
+  std::cout << " Input order: " << order << std::endl;
+  std::cout << " Clusters: " << fsm.clusterCount() << std::endl;
+  std::cout << " Reachable states: " << fsm.reachableStateCount()
+            << std::endl;
+  std::cout << " Reachable set nodes: " << fsm.nodeCount(reachable)
+            << std::endl;
+  std::cout << " Unique table size: " << fsm.uniqueTableSize() << std::endl;
+
+  std::cout << "**** Performance ****" << std::endl;
+  std::cout << " Load runtime: " << load_time << std::endl;
+  std::cout << " Reachability runtime: " << reach_time << std::endl;
+  process_mem_usage(vm2, rss2);
+  std::cout << " VM: " << vm2 - vm1 << "; RSS: " << rss2 - rss1 << std::endl;
+
+  if (!telemetry_file.empty()) {
+    auto csv = telemetry_file.size() >= 4 &&
+               telemetry_file.compare(telemetry_file.size() - 4, 4, ".csv") == 0;
+    const auto &telemetry = fsm.telemetry();
+    std::ofstream telemetry_out(telemetry_file);
+    telemetry_out << (csv ? telemetry.toCsv() : telemetry.toJson());
+    std::cout << " Telemetry written to " << telemetry_file << std::endl;
+  }
+
+  return 0;
+}
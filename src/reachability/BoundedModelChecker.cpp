@@ -0,0 +1,67 @@
+#include "BoundedModelChecker.h"
+
+namespace ClassProject {
+
+BoundedModelChecker::BoundedModelChecker(CompiledFunctions functions,
+                                         const CompiledFunctions &initial,
+                                         unsigned int stateSize,
+                                         unsigned int inputSize)
+    : functions(std::move(functions)), input_size(inputSize) {
+  true_literal = positive(solver.newVar());
+  solver.addClause({true_literal});
+
+  std::vector<Literal> states;
+  for (unsigned int i = 0; i < stateSize; i++) {
+    states.push_back(positive(solver.newVar()));
+  }
+  solver.addClause({encode(initial, states).at(0)});
+  frames.push_back(std::move(states));
+}
+
+int BoundedModelChecker::distance(const std::vector<bool> &state,
+                                  unsigned int bound) {
+  // The first frame that can hold the state is its distance
+  for (unsigned int k = 0; k <= bound; k++) {
+    if (k == frames.size()) unroll();
+
+    std::vector<Literal> assumptions;
+    for (size_t i = 0; i < state.size(); i++) {
+      assumptions.push_back(state[i] ? frames[k][i] : negate(frames[k][i]));
+    }
+    if (solver.solve(assumptions)) return k;
+  }
+  return -1;
+}
+
+void BoundedModelChecker::unroll() {
+  auto variables = frames.back();
+  for (unsigned int j = 0; j < input_size; j++) {
+    variables.push_back(positive(solver.newVar()));
+  }
+  frames.push_back(encode(functions, variables));
+}
+
+std::vector<Literal> BoundedModelChecker::encode(
+    const CompiledFunctions &compiled, const std::vector<Literal> &variables) {
+  std::vector<Literal> slots = {negate(true_literal), true_literal};
+  for (auto &op : compiled.program) {
+    // x == (v ? high : low), the last two clauses only help propagation
+    auto x = positive(solver.newVar());
+    auto v = variables.at(op.var);
+    auto high = slots[op.high];
+    auto low = slots[op.low];
+    solver.addClause({negate(v), negate(high), x});
+    solver.addClause({negate(v), high, negate(x)});
+    solver.addClause({v, negate(low), x});
+    solver.addClause({v, low, negate(x)});
+    solver.addClause({negate(high), negate(low), x});
+    solver.addClause({high, low, negate(x)});
+    slots.push_back(x);
+  }
+
+  std::vector<Literal> outputs;
+  for (auto &slot : compiled.outputs) outputs.push_back(slots[slot]);
+  return outputs;
+}
+
+}  // namespace ClassProject
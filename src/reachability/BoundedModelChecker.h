@@ -0,0 +1,62 @@
+// SAT based bounded reachability
+#pragma once
+
+#include <vector>
+
+#include "ExplicitSearch.h"
+#include "SatSolver.h"
+
+namespace ClassProject {
+
+/**
+ * Unrolls the transition functions frame by frame into CNF: every node of
+ * the compiled functions becomes one multiplexer per frame, and the next
+ * state bits of a frame are the outputs of the previous one. All frames
+ * live in a single incremental solver, targets are passed as assumptions,
+ * so clauses learnt for one query help the next ones.
+ */
+class BoundedModelChecker {
+ public:
+  /**
+   * @brief Encode the initial states as frame 0
+   * @param functions Compiled transition functions
+   * @param initial Compiled characteristic function of the initial states,
+   * with a single output
+   * @param stateSize Number of state bits
+   * @param inputSize Number of input bits
+   */
+  BoundedModelChecker(CompiledFunctions functions,
+                      const CompiledFunctions &initial, unsigned int stateSize,
+                      unsigned int inputSize);
+
+  /**
+   * @brief Distance of a state from the initial states, up to a bound
+   * @param state Target state, one value per state bit
+   * @param bound Largest distance to try
+   * @return int Distance of the state, -1 if it is further than bound or
+   * unreachable
+   */
+  int distance(const std::vector<bool> &state, unsigned int bound);
+
+ private:
+  /**
+   * @brief Encode a compiled program over the given variable literals
+   * @return std::vector<Literal> Literal of each output
+   */
+  std::vector<Literal> encode(const CompiledFunctions &compiled,
+                              const std::vector<Literal> &variables);
+
+  /**
+   * @brief Add the frame following the last one
+   */
+  void unroll();
+
+  SatSolver solver;
+  CompiledFunctions functions;
+  unsigned int input_size;
+  Literal true_literal;
+  /// frames[k] holds the literals of the state bits after k steps
+  std::vector<std::vector<Literal>> frames;
+};
+
+}  // namespace ClassProject
@@ -0,0 +1,126 @@
+#include "ExplicitSearch.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace ClassProject {
+
+ExplicitSearch::ExplicitSearch(CompiledFunctions functions,
+                               unsigned int stateSize, unsigned int inputSize,
+                               const std::vector<uint32_t> &initial)
+    : functions(std::move(functions)),
+      state_size(stateSize),
+      input_size(inputSize),
+      visited(((uint64_t(1) << stateSize) + 63) / 64, 0) {
+  std::vector<uint32_t> layer;
+  for (auto &state : initial) {
+    if (isVisited(state)) continue;
+    visited[state >> 6] |= uint64_t(1) << (state & 63);
+    layer.push_back(state);
+  }
+  std::sort(layer.begin(), layer.end());
+  layers.push_back(std::move(layer));
+  complete = layers.back().empty();
+}
+
+bool ExplicitSearch::expand(unsigned int threads) {
+  if (complete) return false;
+
+  // Each thread takes a contiguous part of the frontier
+  const auto &frontier = layers.back();
+  size_t parts = std::min<size_t>(threads, frontier.size());
+  parts = std::max<size_t>(parts, 1);
+  std::vector<std::vector<uint32_t>> found(parts);
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < parts; t++) {
+    auto first = frontier.size() * t / parts;
+    auto last = frontier.size() * (t + 1) / parts;
+    if (parts == 1) {
+      found[t] = successors(frontier, first, last);
+    } else {
+      workers.emplace_back([this, &found, &frontier, t, first, last] {
+        found[t] = successors(frontier, first, last);
+      });
+    }
+  }
+  for (auto &worker : workers) worker.join();
+
+  std::vector<uint32_t> layer;
+  for (auto &part : found) {
+    for (auto &state : part) {
+      if (isVisited(state)) continue;
+      visited[state >> 6] |= uint64_t(1) << (state & 63);
+      layer.push_back(state);
+    }
+  }
+  if (layer.empty()) {
+    complete = true;
+    return false;
+  }
+
+  std::sort(layer.begin(), layer.end());
+  layers.push_back(std::move(layer));
+  return true;
+}
+
+int ExplicitSearch::distance(uint32_t state, unsigned int threads) {
+  while (!isVisited(state) && expand(threads)) {
+  }
+  if (!isVisited(state)) return -1;
+
+  for (size_t d = 0; d < layers.size(); d++) {
+    if (std::binary_search(layers[d].begin(), layers[d].end(), state)) {
+      return d;
+    }
+  }
+  return -1;
+}
+
+std::vector<uint32_t> ExplicitSearch::successors(
+    const std::vector<uint32_t> &frontier, size_t first, size_t last) const {
+  auto variables = state_size + input_size;
+  std::vector<uint64_t> words(variables);
+  std::vector<uint64_t> slots(functions.program.size() + 2);
+  slots[0] = 0;
+  slots[1] = ~uint64_t(0);
+
+  // Combination c pairs state frontier[first + (c >> input_size)] with input
+  // c & input_mask, lane k of a word holds combination base + k
+  uint64_t combinations = uint64_t(last - first) << input_size;
+  uint64_t input_mask = (uint64_t(1) << input_size) - 1;
+  std::vector<uint32_t> next;
+  for (uint64_t base = 0; base < combinations; base += 64) {
+    auto lanes = std::min<uint64_t>(64, combinations - base);
+    std::fill(words.begin(), words.end(), 0);
+    for (uint64_t k = 0; k < lanes; k++) {
+      auto c = base + k;
+      uint64_t assignment = frontier[first + (c >> input_size)] |
+                            (uint64_t(c & input_mask) << state_size);
+      for (unsigned int v = 0; v < variables; v++) {
+        words[v] |= ((assignment >> v) & 1) << k;
+      }
+    }
+
+    for (size_t j = 0; j < functions.program.size(); j++) {
+      const auto &op = functions.program[j];
+      auto var = words[op.var];
+      slots[j + 2] = (var & slots[op.high]) | (~var & slots[op.low]);
+    }
+
+    for (uint64_t k = 0; k < lanes; k++) {
+      uint32_t state = 0;
+      for (unsigned int i = 0; i < state_size; i++) {
+        state |= uint32_t((slots[functions.outputs[i]] >> k) & 1) << i;
+      }
+      if (!isVisited(state) && (next.empty() || next.back() != state)) {
+        next.push_back(state);
+      }
+    }
+  }
+
+  std::sort(next.begin(), next.end());
+  next.erase(std::unique(next.begin(), next.end()), next.end());
+  return next;
+}
+
+}  // namespace ClassProject
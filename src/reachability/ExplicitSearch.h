@@ -0,0 +1,90 @@
+// Explicit-state breadth-first search for small state machines
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ClassProject {
+
+/**
+ * Transition functions compiled for bit-parallel evaluation. Every
+ * instruction is one BDD node, slot = var ? high : low, evaluated for 64
+ * state and input combinations at once, one per bit of a word. Slots 0 and
+ * 1 hold the constants False and True, instruction k writes slot k + 2 and
+ * only reads slots written before.
+ */
+struct CompiledFunctions {
+  struct Instruction {
+    /// Position of the variable among the state bits followed by the inputs
+    uint32_t var;
+    uint32_t high;
+    uint32_t low;
+  };
+
+  std::vector<Instruction> program;
+  /// Slot of the transition function of each state bit
+  std::vector<uint32_t> outputs;
+};
+
+/**
+ * Breadth-first search over the state space, one integer per state with
+ * state bit i at bit i. Visited states are kept in a dense bitset of
+ * 2^stateSize bits and the layers of the search are extended lazily, like
+ * the onion rings of the symbolic traversal.
+ */
+class ExplicitSearch {
+ public:
+  /**
+   * @brief Start a search from a set of initial states
+   * @param functions Compiled transition functions
+   * @param stateSize Number of state bits, at most 32
+   * @param inputSize Number of input bits
+   * @param initial Initial states
+   */
+  ExplicitSearch(CompiledFunctions functions, unsigned int stateSize,
+                 unsigned int inputSize, const std::vector<uint32_t> &initial);
+
+  /**
+   * @brief Add the next layer of the search
+   * @param threads Number of threads computing the successors
+   * @return bool False if the fixpoint was already reached
+   */
+  bool expand(unsigned int threads);
+
+  /**
+   * @brief Distance of a state from the initial states
+   *
+   * Expands the search only until the state is found.
+   *
+   * @param state State to look up
+   * @param threads Number of threads computing the successors
+   * @return int Distance of the state, -1 if unreachable
+   */
+  int distance(uint32_t state, unsigned int threads);
+
+ private:
+  /**
+   * @brief Successors of frontier[first, last) under every input
+   *
+   * Successors that were visited before are skipped, the others are
+   * returned sorted and without duplicates.
+   */
+  std::vector<uint32_t> successors(const std::vector<uint32_t> &frontier,
+                                   size_t first, size_t last) const;
+
+  bool isVisited(uint32_t state) const {
+    return (visited[state >> 6] >> (state & 63)) & 1;
+  }
+
+  CompiledFunctions functions;
+  unsigned int state_size;
+  unsigned int input_size;
+
+  std::vector<uint64_t> visited;
+  /// layers[d] holds the states at distance d, sorted
+  std::vector<std::vector<uint32_t>> layers;
+  bool complete = false;
+};
+
+}  // namespace ClassProject
@@ -0,0 +1,38 @@
+#include "FixpointTelemetry.h"
+
+#include <fmt/format.h>
+
+namespace ClassProject {
+
+std::string FixpointTelemetry::toJson() const {
+  std::string json = "[";
+  for (size_t k = 0; k < iterations.size(); k++) {
+    const auto &it = iterations[k];
+    json += fmt::format(
+        "{}\n  {{\"iteration\": {}, \"frontier_nodes\": {}, "
+        "\"reached_nodes\": {}, \"reached_states\": {}, \"image_time_ns\": {}, "
+        "\"unique_table_size\": {}, \"computed_lookups\": {}, "
+        "\"computed_hits\": {}, \"hit_rate\": {:.4f}}}",
+        k ? "," : "", it.iteration, it.frontier_nodes, it.reached_nodes,
+        it.reached_states.str(), it.image_time.count(), it.unique_table_size,
+        it.computed_lookups, it.computed_hits, it.hitRate());
+  }
+  json += iterations.empty() ? "]\n" : "\n]\n";
+  return json;
+}
+
+std::string FixpointTelemetry::toCsv() const {
+  std::string csv =
+      "Iteration,FrontierNodes,ReachedNodes,ReachedStates,ImageTimeNs,"
+      "UniqueTableSize,ComputedLookups,ComputedHits,HitRate\n";
+  for (const auto &it : iterations) {
+    csv += fmt::format("{},{},{},{},{},{},{},{},{:.4f}\n", it.iteration,
+                       it.frontier_nodes, it.reached_nodes,
+                       it.reached_states.str(), it.image_time.count(),
+                       it.unique_table_size, it.computed_lookups,
+                       it.computed_hits, it.hitRate());
+  }
+  return csv;
+}
+
+}  // namespace ClassProject
@@ -0,0 +1,48 @@
+// Per-iteration telemetry of the reachability fixpoint
+#pragma once
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace ClassProject {
+
+/**
+ * @brief One iteration of the forward traversal, i.e. one onion ring
+ */
+struct FixpointIteration {
+  size_t iteration;
+  size_t frontier_nodes;  ///< Nodes of the states first reached now
+  size_t reached_nodes;   ///< Nodes of all states reached so far
+  boost::multiprecision::cpp_int reached_states;
+  std::chrono::nanoseconds image_time;
+  /// Unique table size after the iteration. Nodes are only removed by a
+  /// rollback, so this is also the peak during the iteration.
+  size_t unique_table_size;
+  size_t computed_lookups;  ///< Computed table lookups of this iteration
+  size_t computed_hits;
+
+  double hitRate() const {
+    return computed_lookups ? double(computed_hits) / computed_lookups : 0;
+  }
+};
+
+/**
+ * @brief Iterations recorded by a Reachability while telemetry is enabled
+ */
+struct FixpointTelemetry {
+  std::vector<FixpointIteration> iterations;
+
+  /**
+   * @brief Serialize all iterations as a JSON array of objects
+   */
+  std::string toJson() const;
+
+  /**
+   * @brief Serialize all iterations as CSV with a header line
+   */
+  std::string toCsv() const;
+};
+
+}  // namespace ClassProject
@@ -2,69 +2,783 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <boost/dynamic_bitset.hpp>
 #include <cmath>
+#include <map>
+#include <set>
+#include <thread>
 
 namespace ClassProject {
 
-Reachability::Reachability(unsigned int stateSize, unsigned int inputSize)
-    : states(stateSize, 0),
+Reachability::Reachability(unsigned int stateSize, unsigned int inputSize,
+                           const OrderingPolicy &policy)
+    : Reachability(std::make_shared<NodeTable>(), stateSize, inputSize,
+                   policy) {}
+
+Reachability::Reachability(Manager &manager, unsigned int stateSize,
+                           unsigned int inputSize, const OrderingPolicy &policy)
+    : Reachability(manager.nodeTable(), stateSize, inputSize, policy) {}
+
+Reachability::Reachability(std::shared_ptr<NodeTable> table,
+                           unsigned int stateSize, unsigned int inputSize,
+                           const OrderingPolicy &policy)
+    : ReachabilityInterface(std::move(table)),
+      states(stateSize, 0),
       inputs(inputSize, 0),
       next_states(stateSize, 0),
       init_state(stateSize, false),
       transitionFunctions(stateSize, 0),
-      tau(True()),
-      cs0(True()) {
+      cs0(True()),
+      identity(True()),
+      reached(False()),
+      squared_reached(False()),
+      approximation(False()) {
+  setQueryThreads(0);
   if (stateSize == 0) throw std::runtime_error(">>> stateSize is zero! <<<");
 
-  for (unsigned int i = 0; i < stateSize; i++) {
+  // Number of state bits placed before each input
+  std::vector<unsigned int> input_positions(
+      inputSize, policy.order == VariableOrder::InputsFirst ? 0 : stateSize);
+  if (policy.order == VariableOrder::Custom) {
+    if (policy.input_positions.size() != inputSize) {
+      throw std::runtime_error(
+          ">>> The custom order does not place every input! <<<");
+    }
+    for (auto &position : policy.input_positions) {
+      if (position > stateSize) {
+        throw std::runtime_error(">>> Input position out of range! <<<");
+      }
+    }
+    input_positions = policy.input_positions;
+  }
+
+  std::vector<std::vector<unsigned int>> inputs_at(stateSize + 1);
+  for (unsigned int j = 0; j < inputSize; j++) {
+    inputs_at[input_positions[j]].push_back(j);
+  }
+
+  for (unsigned int i = 0; i <= stateSize; i++) {
+    for (auto &j : inputs_at[i]) {
+      inputs[j] = createVar(fmt::format("i{}", j));
+    }
+    if (i == stateSize) break;
+
     transitionFunctions[i] = states[i] = createVar(fmt::format("s{}", i));
     next_states[i] = createVar(fmt::format("s{}'", i));
   }
 
-  for (unsigned int i = 0; i < inputSize; i++) {
-    inputs[i] = createVar(fmt::format("i{}", i));
+  state_position.assign(uniqueTableSize(), -1);
+  std::vector<BDD_ID> pairs;
+  for (unsigned int i = 0; i < stateSize; i++) {
+    state_position[states[i]] = i;
+    pairs.push_back(xnor2(states[i], next_states[i]));
   }
+  identity = andN(pairs);
 
   setInitState(std::vector<bool>(stateSize, false));
   setTransitionFunctions(std::vector<BDD_ID>(stateSize, 0));
 }
 
 bool Reachability::isReachable(const std::vector<bool> &stateVector) {
-  return stateDistance(stateVector) >= 0;
+  checkStateVector(stateVector);
+
+  if (exploration_mode == Exploration::Bounded || explicitSearch()) {
+    return stateDistance(stateVector) >= 0;
+  }
+
+  try {
+    if (approximation_block > 0 && !rings_complete &&
+        !contains(overApproximation(), stateVector)) {
+      return false;
+    }
+
+    if (iterative_squaring && search_mode == SearchMode::Forward) {
+      return squaredDistance(stateVector) >= 0;
+    }
+
+    if (search_mode == SearchMode::Forward || rings_complete ||
+        (!rings.empty() && contains(reached, stateVector))) {
+      return ringDistance(stateVector) >= 0;
+    }
+
+    return searchBackward(stateVector);
+  } catch (const ResourceExhausted &exhausted) {
+    return boundedFallback(stateVector, exhausted) >= 0;
+  }
+}
+
+void Reachability::setExploration(Exploration mode) {
+  if (mode == Exploration::Explicit && (states.size() > EXPLICIT_MAX_BITS ||
+                                        inputs.size() > EXPLICIT_MAX_BITS)) {
+    throw std::runtime_error(
+        ">>> The state machine is too wide for explicit search! <<<");
+  }
+  exploration_mode = mode;
+}
+
+ExplicitSearch *Reachability::explicitSearch() {
+  if (exploration_mode == Exploration::Symbolic) return nullptr;
+  if (exploration_mode == Exploration::Automatic &&
+      (search_mode != SearchMode::Forward || iterative_squaring ||
+       states.size() > EXPLICIT_STATE_BITS ||
+       states.size() + inputs.size() > EXPLICIT_COMBINATION_BITS)) {
+    return nullptr;
+  }
+  if (explicit_search) return explicit_search.get();
+
+  CompiledFunctions compiled;
+  if (!compileFunctions(transitionFunctions, compiled)) return nullptr;
+
+  std::vector<uint32_t> initial;
+  collectStates(cs0, 0, 0, initial);
+  explicit_search = std::make_unique<ExplicitSearch>(
+      std::move(compiled), states.size(), inputs.size(), initial);
+  return explicit_search.get();
+}
+
+BoundedModelChecker *Reachability::boundedChecker() {
+  if (bounded_checker) return bounded_checker.get();
+
+  CompiledFunctions functions, initial;
+  if (!compileFunctions(transitionFunctions, functions) ||
+      !compileFunctions({cs0}, initial)) {
+    return nullptr;
+  }
+  bounded_checker = std::make_unique<BoundedModelChecker>(
+      std::move(functions), initial, states.size(), inputs.size());
+  return bounded_checker.get();
+}
+
+int Reachability::boundedDistance(const std::vector<bool> &stateVector) {
+  auto checker = boundedChecker();
+  if (!checker) {
+    throw std::runtime_error(
+        ">>> The transition functions depend on non-state variables! <<<");
+  }
+  auto distance = checker->distance(stateVector, bmc_bound);
+
+  // A shortest path visits every state at most once
+  bool complete = states.size() < 64 &&
+                  bmc_bound >= (uint64_t(1) << states.size()) - 1;
+  if (distance < 0 && !complete) {
+    throw BoundReached(fmt::format(
+        ">>> State not reached within the bound of {} steps! <<<", bmc_bound));
+  }
+  return distance;
+}
+
+int Reachability::boundedFallback(const std::vector<bool> &stateVector,
+                                  const ResourceExhausted &exhausted) {
+  if (bmc_bound == 0 ||
+      exhausted.reason() != ResourceExhausted::Reason::NodeLimit ||
+      !boundedChecker()) {
+    throw;
+  }
+
+  int distance = -1;
+  bool proven = true;
+  try {
+    distance = boundedDistance(stateVector);
+  } catch (const BoundReached &) {
+    proven = false;
+  }
+  if (!proven) throw;
+  spdlog::debug("bounded model checking took over: {}", exhausted.what());
+  return distance;
+}
+
+bool Reachability::compileFunctions(const std::vector<BDD_ID> &functions,
+                                    CompiledFunctions &compiled) {
+  // Position of each variable among the states followed by the inputs
+  std::unordered_map<BDD_ID, uint32_t> positions;
+  for (size_t i = 0; i < states.size(); i++) positions[states[i]] = i;
+  for (size_t j = 0; j < inputs.size(); j++) {
+    positions[inputs[j]] = states.size() + j;
+  }
+
+  std::set<BDD_ID> nodes;
+  for (auto &f : functions) findNodes(f, nodes);
+
+  // Children have smaller IDs than their parents, so ascending IDs evaluate
+  // every child first
+  std::unordered_map<BDD_ID, uint32_t> slots = {{False(), 0}, {True(), 1}};
+  for (auto &id : nodes) {
+    auto node = getNode(id);
+    if (node->isConstant()) continue;
+
+    auto position = positions.find(node->top);
+    if (position == positions.end()) return false;
+
+    compiled.program.push_back(
+        {position->second, slots.at(node->high), slots.at(node->low)});
+    slots[id] = compiled.program.size() + 1;
+  }
+
+  for (auto &f : functions) compiled.outputs.push_back(slots.at(f));
+  return true;
+}
+
+void Reachability::collectStates(const BDD_ID &f, size_t position,
+                                 uint32_t state,
+                                 std::vector<uint32_t> &collected) {
+  if (f == False()) return;
+  if (position == states.size()) {
+    collected.push_back(state);
+    return;
+  }
+
+  // A bit the BDD skips can take either value
+  auto node = getNode(f);
+  auto skipped = statePosition(f) > position;
+  collectStates(skipped ? f : node->low, position + 1, state, collected);
+  collectStates(skipped ? f : node->high, position + 1,
+                state | uint32_t(1) << position, collected);
+}
+
+void Reachability::setApproximation(size_t block_size, size_t overlap) {
+  if (block_size > 0 && overlap >= block_size) {
+    throw std::runtime_error(
+        ">>> The overlap must be smaller than the block size! <<<");
+  }
+  if (block_size == approximation_block && overlap == approximation_overlap) {
+    return;
+  }
+
+  approximation_block = block_size;
+  approximation_overlap = overlap;
+  approximation_valid = false;
+}
+
+BDD_ID Reachability::overApproximation() {
+  if (approximation_valid) return approximation;
+
+  // Overlapping blocks [first, last) covering all state bits
+  auto size = approximation_block ? approximation_block : states.size();
+  std::vector<std::pair<size_t, size_t>> blocks;
+  for (size_t first = 0;; first += size - approximation_overlap) {
+    blocks.emplace_back(first, std::min(first + size, states.size()));
+    if (blocks.back().second == states.size()) break;
+  }
+
+  // Each block starts with the projection of the initial states and the
+  // relation of its own bits
+  std::vector<BDD_ID> reached_blocks, block_relations;
+  std::vector<std::vector<BDD_ID>> block_next_states, block_states;
+  for (auto &block : blocks) {
+    std::vector<BDD_ID> others, block_relation;
+    for (size_t i = 0; i < states.size(); i++) {
+      if (i < block.first || i >= block.second) others.push_back(states[i]);
+    }
+    for (size_t i = block.first; i < block.second; i++) {
+      block_relation.push_back(xnor2(next_states[i], transitionFunctions[i]));
+    }
+    reached_blocks.push_back(existential_quantification(cs0, others));
+    block_relations.push_back(andN(block_relation));
+    block_states.emplace_back(states.begin() + block.first,
+                              states.begin() + block.second);
+    block_next_states.emplace_back(next_states.begin() + block.first,
+                                   next_states.begin() + block.second);
+  }
+
+  // Sub-machine images from the product of all blocks, until no block grows
+  auto variables = states;
+  variables.insert(variables.end(), inputs.begin(), inputs.end());
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t b = 0; b < blocks.size(); b++) {
+      auto step = andExists(andN(reached_blocks), block_relations[b],
+                            variables);
+      auto grown = or2(reached_blocks[b],
+                       rename(step, block_next_states[b], block_states[b]));
+      if (grown == reached_blocks[b]) continue;
+
+      reached_blocks[b] = grown;
+      changed = true;
+    }
+    spdlog::debug("approximation: {}", andN(reached_blocks));
+  }
+
+  approximation = andN(reached_blocks);
+  approximation_valid = true;
+  return approximation;
+}
+
+BDD_ID Reachability::reachableStates() {
+  if (iterative_squaring) {
+    buildClosures();
+    if (!squared_reached_valid) {
+      squared_reached = post(cs0, closures.back());
+      squared_reached_valid = true;
+    }
+    return squared_reached;
+  }
+
+  while (expandRings()) {
+  }
+  return reached;
+}
+
+InvariantResult Reachability::checkInvariant(const BDD_ID &property,
+                                             bool witness) {
+  checkStateSet(property, "property");
+
+  InvariantResult result = {true, 0, {}};
+  auto violations = neg(property);
+  for (size_t depth = 0; depth < rings.size() || expandRings(); depth++) {
+    auto bad = and2(rings[depth], violations);
+    if (bad == False()) continue;
+
+    result.holds = false;
+    result.depth = depth;
+    if (witness) {
+      std::vector<bool> stateVector(states.size(), false), inputVector;
+      pickAssignment(bad, stateVector, inputVector);
+      result.witness = traceTo(stateVector);
+    }
+    return result;
+  }
+
+  result.depth = rings.size() - 1;
+  return result;
+}
+
+boost::multiprecision::cpp_int Reachability::reachableStateCount() {
+  return stateCount(reachableStates());
+}
+
+boost::multiprecision::cpp_int Reachability::stateCount(const BDD_ID &set) {
+  std::unordered_map<BDD_ID, boost::multiprecision::cpp_int> counts;
+
+  // Bits above the top variable are not constrained
+  boost::multiprecision::cpp_int free = 1;
+  return (free << statePosition(set)) * countStates(set, counts);
+}
+
+boost::multiprecision::cpp_int Reachability::countStates(
+    const BDD_ID &f,
+    std::unordered_map<BDD_ID, boost::multiprecision::cpp_int> &counts) {
+  if (f == False()) return 0;
+  if (f == True()) return 1;
+
+  auto cached = counts.find(f);
+  if (cached != counts.end()) return cached->second;
+
+  // Bits skipped between a node and its children can take any value
+  auto node = getNode(f);
+  auto position = statePosition(f);
+  boost::multiprecision::cpp_int count =
+      (countStates(node->high, counts)
+       << (statePosition(node->high) - position - 1)) +
+      (countStates(node->low, counts)
+       << (statePosition(node->low) - position - 1));
+
+  counts.emplace(f, count);
+  return count;
+}
+
+size_t Reachability::statePosition(const BDD_ID &f) {
+  auto node = getNode(f);
+  if (node->isConstant()) return states.size();
+  auto position =
+      node->top < state_position.size() ? state_position[node->top] : -1;
+  if (position < 0) {
+    throw std::logic_error(">>> Set depends on non-state variables! <<<");
+  }
+  return position;
+}
+
+Reachability::CubeEnumerator Reachability::enumerateReachableStates() {
+  return CubeEnumerator(*this, reachableStates());
+}
+
+Reachability::CubeEnumerator::CubeEnumerator(Reachability &fsm,
+                                             const BDD_ID &set)
+    : fsm(fsm) {
+  if (set != fsm.False()) {
+    pending.emplace_back(
+        set, StateCube(fsm.states.size(), CubeValue::DontCare));
+  }
+}
+
+std::vector<StateCube> Reachability::CubeEnumerator::nextPage(
+    size_t page_size) {
+  std::vector<StateCube> page;
+  while (!pending.empty() && page.size() < page_size) {
+    auto [id, cube] = std::move(pending.back());
+    pending.pop_back();
+
+    auto node = fsm.getNode(id);
+    if (node->isConstant()) {
+      if (id == fsm.True()) page.push_back(std::move(cube));
+      continue;
+    }
+
+    // Follow both branches, the low one first
+    auto position = fsm.statePosition(id);
+    if (node->high != fsm.False()) {
+      auto high = cube;
+      high[position] = CubeValue::True;
+      pending.emplace_back(node->high, std::move(high));
+    }
+    if (node->low != fsm.False()) {
+      cube[position] = CubeValue::False;
+      pending.emplace_back(node->low, std::move(cube));
+    }
+  }
+  return page;
+}
+
+std::vector<bool> Reachability::areReachable(
+    const std::vector<std::vector<bool>> &stateVectors) {
+  for (auto &stateVector : stateVectors) checkStateVector(stateVector);
+  while (expandRings()) {
+  }
+
+  // std::vector<bool> packs bits, so threads write to separate bytes first
+  std::vector<char> reachable(stateVectors.size());
+  parallelFor(stateVectors.size(), [&](size_t i) {
+    reachable[i] = contains(reached, stateVectors[i]);
+  });
+  return std::vector<bool>(reachable.begin(), reachable.end());
+}
+
+std::vector<int> Reachability::stateDistances(
+    const std::vector<std::vector<bool>> &stateVectors) {
+  for (auto &stateVector : stateVectors) checkStateVector(stateVector);
+  while (expandRings()) {
+  }
+
+  std::vector<int> distances(stateVectors.size(), -1);
+  parallelFor(stateVectors.size(), [&](size_t i) {
+    if (!contains(reached, stateVectors[i])) return;
+    for (size_t distance = 0; distance < rings.size(); distance++) {
+      if (contains(rings[distance], stateVectors[i])) {
+        distances[i] = distance;
+        return;
+      }
+    }
+  });
+  return distances;
+}
+
+Trace Reachability::traceTo(const std::vector<bool> &stateVector) {
+  checkStateVector(stateVector);
+
+  Trace trace;
+  auto distance = ringDistance(stateVector);
+  if (distance < 0) return trace;
+
+  trace.states.resize(distance + 1);
+  trace.inputs.resize(distance);
+  trace.states[distance] = stateVector;
+  for (int step = distance; step > 0; step--) {
+    // States of the previous ring with an input leading to the current state
+    auto predecessors =
+        and2(rings[step - 1], composeStates(stateCube(trace.states[step])));
+
+    trace.states[step - 1].assign(states.size(), false);
+    trace.inputs[step - 1].assign(inputs.size(), false);
+    pickAssignment(predecessors, trace.states[step - 1],
+                   trace.inputs[step - 1]);
+  }
+  return trace;
+}
+
+void Reachability::setQueryThreads(unsigned int threads) {
+  query_threads = threads ? threads : std::thread::hardware_concurrency();
+  if (query_threads == 0) query_threads = 1;
+}
+
+void Reachability::parallelFor(size_t count,
+                               const std::function<void(size_t)> &body) {
+  // Not worth a thread for a handful of queries
+  static constexpr size_t MIN_QUERIES_PER_THREAD = 64;
+  size_t threads = std::min<size_t>(
+      query_threads, (count + MIN_QUERIES_PER_THREAD - 1) /
+                         MIN_QUERIES_PER_THREAD);
+  if (threads <= 1) {
+    for (size_t i = 0; i < count; i++) body(i);
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&body, count, threads, t] {
+      for (size_t i = t; i < count; i += threads) body(i);
+    });
+  }
+  for (auto &worker : workers) worker.join();
+}
+
+bool Reachability::searchBackward(const std::vector<bool> &stateVector) {
+  auto forward = search_mode == SearchMode::Bidirectional;
+  if (rings.empty()) expandRings();
+
+  auto visited = stateCube(stateVector);
+  auto frontier = visited;
+  while (true) {
+    // Any state reaching the target that is reachable itself
+    if (and2(visited, forward ? reached : cs0) != False()) return true;
+    if (forward && rings_complete) return false;
+
+    if (forward && nodeCount(rings.back()) <= nodeCount(frontier)) {
+      expandRings();
+      continue;
+    }
+
+    frontier = and2(preimage(frontier), neg(visited));
+    spdlog::debug("backward frontier: {}", frontier);
+    if (frontier == False()) return false;
+    visited = or2(visited, frontier);
+  }
 }
 
 int Reachability::stateDistance(const std::vector<bool> &stateVector) {
+  checkStateVector(stateVector);
+
+  if (exploration_mode == Exploration::Bounded) {
+    return boundedDistance(stateVector);
+  }
+
+  if (auto search = explicitSearch()) {
+    uint32_t state = 0;
+    for (size_t i = 0; i < stateVector.size(); i++) {
+      state |= uint32_t(stateVector[i]) << i;
+    }
+    return search->distance(state, query_threads);
+  }
+
+  try {
+    if (iterative_squaring) return squaredDistance(stateVector);
+
+    return ringDistance(stateVector);
+  } catch (const ResourceExhausted &exhausted) {
+    return boundedFallback(stateVector, exhausted);
+  }
+}
+
+int Reachability::ringDistance(const std::vector<bool> &stateVector) {
+  if (rings_complete && !contains(reached, stateVector)) return -1;
+
+  for (size_t distance = 0; distance < rings.size(); distance++) {
+    if (contains(rings[distance], stateVector)) return distance;
+  }
+
+  while (expandRings()) {
+    if (contains(rings.back(), stateVector)) return rings.size() - 1;
+  }
+
+  return -1;
+}
+
+void Reachability::checkStateSet(const BDD_ID &f, const std::string &what) {
+  if (f >= uniqueTableSize()) {
+    throw std::runtime_error(">>> An unknown ID is provided! <<<");
+  }
+  for (auto &var : findVars(f)) {
+    if (var >= state_position.size() || state_position[var] < 0) {
+      throw std::runtime_error(
+          fmt::format(">>> The {} depends on non-state variables! <<<", what));
+    }
+  }
+}
+
+void Reachability::checkStateVector(
+    const std::vector<bool> &stateVector) const {
   if (stateVector.size() != init_state.size()) {
     throw std::runtime_error(
         ">>> StateVector size does not match with number of state bits! <<<");
   }
+}
 
-  auto cr_it = cs0;
-  auto cr = cr_it;
-  auto distance = 0;
-  do {
-    cr = cr_it;
-    // Compute BBD for image of next states
-    auto img_next = existential_quantification(
-        existential_quantification(and2(cr, tau), states), inputs);
+BDD_ID Reachability::image(const BDD_ID &frontier) {
+  if (image_engine == ImageEngine::Functions) {
+    if (frontier == False()) return False();
 
-    // Compute BDD for image of current states
-    auto img = True();
-    for (size_t i = 0; i < stateVector.size(); i++) {
-      img = and2(img, xnor2(states[i], next_states[i]));
+    PairCache constrained;
+    std::map<std::vector<BDD_ID>, BDD_ID> ranges;
+    std::vector<BDD_ID> functions;
+    for (auto &f : transitionFunctions) {
+      functions.push_back(constrain(f, frontier, constrained));
+    }
+    return range(functions, 0, constrained, ranges);
+  }
+
+  // Conjoin one cluster at a time and drop each state and input variable as
+  // soon as no later cluster depends on it
+  auto product = existential_quantification(frontier, quantify_first);
+  for (size_t j = 0; j < clusters.size(); j++) {
+    product = andExists(product, clusters[j], quantify_after[j]);
+  }
+
+  // Rename the image back to the current state variables
+  return andExists(identity, product, next_states);
+}
+
+BDD_ID Reachability::preimage(const BDD_ID &set) {
+  return existential_quantification(composeStates(set), inputs);
+}
+
+BDD_ID Reachability::composeStates(const BDD_ID &f) {
+  return rename(f, states, transitionFunctions);
+}
+
+BDD_ID Reachability::rename(const BDD_ID &f, const std::vector<BDD_ID> &from,
+                            const std::vector<BDD_ID> &to) {
+  std::unordered_map<BDD_ID, BDD_ID> substitution;
+  for (size_t i = 0; i < from.size(); i++) substitution[from[i]] = to[i];
+
+  std::unordered_map<BDD_ID, BDD_ID> cache;
+  return compose(f, substitution, cache);
+}
+
+BDD_ID Reachability::compose(
+    const BDD_ID &f, const std::unordered_map<BDD_ID, BDD_ID> &substitution,
+    std::unordered_map<BDD_ID, BDD_ID> &cache) {
+  auto node = getNode(f);
+  if (node->isConstant()) return f;
+
+  auto cached = cache.find(f);
+  if (cached != cache.end()) return cached->second;
+
+  auto replacement = substitution.find(node->top);
+  auto result = ite(replacement == substitution.end() ? node->top
+                                                      : replacement->second,
+                    compose(node->high, substitution, cache),
+                    compose(node->low, substitution, cache));
+
+  cache.emplace(f, result);
+  return result;
+}
+
+void Reachability::pickAssignment(const BDD_ID &f,
+                                  std::vector<bool> &stateVector,
+                                  std::vector<bool> &inputVector) {
+  auto node = getNode(f);
+  while (!node->isConstant()) {
+    auto value = node->low == False();
+    auto position =
+        node->top < state_position.size() ? state_position[node->top] : -1;
+    if (position >= 0) {
+      stateVector[position] = value;
+    } else {
+      auto input = std::find(inputs.begin(), inputs.end(), node->top);
+      if (input != inputs.end()) inputVector[input - inputs.begin()] = value;
     }
-    img = existential_quantification(
-        existential_quantification(and2(img, img_next), next_states), inputs);
+    node = getNode(value ? node->high : node->low);
+  }
+}
+
+BDD_ID Reachability::stateCube(const std::vector<bool> &stateVector) {
+  auto cube = True();
+  for (size_t i = 0; i < stateVector.size(); i++) {
+    cube = and2(cube, xnor2(states[i], stateVector[i]));
+  }
+  return cube;
+}
+
+bool Reachability::expandRings() {
+  if (rings_complete) return false;
+
+  auto start = std::chrono::steady_clock::now();
+  auto lookups = stats().computed_lookups;
+  auto hits = stats().computed_hits;
+
+  auto iteration = rings.size();
+  auto ring = rings.empty() ? cs0 : and2(image(rings.back()), neg(reached));
+  spdlog::debug("ring {}: {}", iteration, ring);
+  auto image_time = std::chrono::steady_clock::now() - start;
+  if (!rings.empty() && ring == False()) {
+    rings_complete = true;
+  } else {
+    // or2 may run out of resources, so nothing is cached until it returned
+    auto new_reached = or2(reached, ring);
+    rings.push_back(ring);
+    reached = new_reached;
+  }
+
+  if (record_telemetry) {
+    telemetry_log.iterations.push_back(
+        {iteration, nodeCount(ring), nodeCount(reached), stateCount(reached),
+         image_time, uniqueTableSize(), stats().computed_lookups - lookups,
+         stats().computed_hits - hits});
+  }
+  return !rings_complete;
+}
+
+void Reachability::recordTelemetry(bool enable) {
+  if (enable == record_telemetry) return;
+
+  record_telemetry = enable;
+  if (enable) {
+    stats_before_telemetry = statsEnabled();
+    enableStats();
+  } else {
+    enableStats(stats_before_telemetry);
+  }
+}
+
+void Reachability::invalidateRings() {
+  rings.clear();
+  reached = False();
+  rings_complete = false;
+  squared_reached_valid = false;
+  approximation_valid = false;
+  explicit_search.reset();
+  bounded_checker.reset();
+}
+
+void Reachability::buildClosures() {
+  if (closures_complete) return;
 
-    cr_it = or2(cr, img);
-    distance++;
+  if (middle_states.empty()) {
+    for (size_t i = 0; i < states.size(); i++) {
+      middle_states.push_back(createVar(fmt::format("s{}''", i)));
+    }
+  }
+
+  // At most one step: stay or take a transition with any input
+  auto one_step = existential_quantification(
+      andN(relations.empty() ? buildRelations(transitionFunctions) : relations),
+      inputs);
+  std::vector<BDD_ID> new_closures = {or2(identity, one_step)};
+
+  // At most 2k steps: k steps to a middle state, then k steps from there
+  while (true) {
+    auto closure = new_closures.back();
+    auto squared =
+        andExists(rename(closure, next_states, middle_states),
+                  rename(closure, states, middle_states), middle_states);
+    spdlog::debug("closure {}: {}", new_closures.size(), squared);
+    if (squared == closure) break;
+    new_closures.push_back(squared);
+  }
 
-    // Check if the state is reachable at this iteration
-    spdlog::debug("cr: {}", cr);
-  } while (!test_reachability(cr, stateVector) && cr_it != cr);
+  closures = new_closures;
+  closures_complete = true;
+}
 
-  return test_reachability(cr, stateVector) ? distance - 1 : -1;
+BDD_ID Reachability::post(const BDD_ID &set, const BDD_ID &relation) {
+  return andExists(identity, andExists(set, relation, states), next_states);
+}
+
+int Reachability::squaredDistance(const std::vector<bool> &stateVector) {
+  if (!contains(reachableStates(), stateVector)) return -1;
+  if (contains(cs0, stateVector)) return 0;
+
+  // Largest number of steps that does not reach the state yet, the state is
+  // reached one step later
+  auto within = cs0;
+  int steps = 0;
+  for (int j = closures.size() - 1; j >= 0; j--) {
+    auto further = post(within, closures[j]);
+    if (!contains(further, stateVector)) {
+      within = further;
+      steps += 1 << j;
+    }
+  }
+  return steps + 1;
 }
 
 void Reachability::setTransitionFunctions(
@@ -76,43 +790,332 @@ void Reachability::setTransitionFunctions(
   }
 
   for (auto &tf : transitionFunctions) {
-    if (tf > uniqueTableSize()) {
+    if (tf >= uniqueTableSize()) {
       throw std::runtime_error(">>> An unknown ID is provided! <<<");
     }
   }
 
+  // Only bits whose function changed need a new relation, and the cached
+  // results stay valid if nothing changed at all
+  auto rebuild = image_engine == ImageEngine::Relation && relations.empty();
+  std::vector<bool> changed(transitionFunctions.size(), rebuild);
+  for (size_t i = 0; i < transitionFunctions.size(); i++) {
+    if (transitionFunctions[i] != this->transitionFunctions[i]) {
+      changed[i] = true;
+    }
+  }
+  if (std::none_of(changed.begin(), changed.end(), [](bool c) { return c; })) {
+    return;
+  }
+
+  // Update the partitioned transition relation, unless images are computed
+  // from the functions. Members are only updated once it is complete, so an
+  // aborted computation leaves the previous FSM intact.
+  std::vector<BDD_ID> new_relations;
+  if (image_engine == ImageEngine::Relation) {
+    new_relations = rebuild ? buildRelations(transitionFunctions) : relations;
+    for (size_t i = 0; i < transitionFunctions.size() && !rebuild; i++) {
+      if (changed[i]) {
+        new_relations[i] = xnor2(next_states[i], transitionFunctions[i]);
+      }
+    }
+  }
+  buildPartition(new_relations, changed);
+
   this->transitionFunctions = transitionFunctions;
+  relations = new_relations;
+  closures.clear();
+  closures_complete = false;
+  invalidateRings();
+}
 
-  // Compute Transition Relation tau
-  tau = True();
-  for (size_t i = 0; i < this->transitionFunctions.size(); i++) {
-    tau = and2(
-        tau, or2(and2(next_states[i], this->transitionFunctions[i]),
-                 and2(neg(next_states[i]), neg(this->transitionFunctions[i]))));
+void Reachability::setClusterThreshold(size_t threshold) {
+  auto previous = cluster_threshold;
+  cluster_threshold = threshold;
+  try {
+    buildPartition(relations, std::vector<bool>(relations.size(), true));
+  } catch (...) {
+    cluster_threshold = previous;
+    throw;
   }
 }
 
-void Reachability::setInitState(const std::vector<bool> &stateVector) {
-  if (stateVector.size() != init_state.size()) {
-    throw std::runtime_error(
-        ">>> StateVector size does not match with number of state bits! <<<");
+void Reachability::setImageEngine(ImageEngine engine) {
+  if (engine == ImageEngine::Relation && relations.empty()) {
+    auto new_relations = buildRelations(transitionFunctions);
+    buildPartition(new_relations,
+                   std::vector<bool>(new_relations.size(), true));
+    relations = new_relations;
   }
-  init_state = stateVector;
+  image_engine = engine;
+}
 
-  // Compute Characteristic Function for Initial State (CS0)
-  cs0 = True();
-  for (size_t i = 0; i < init_state.size(); i++) {
-    cs0 = and2(cs0, xnor2(states[i], init_state[i]));
+std::vector<BDD_ID> Reachability::buildRelations(
+    const std::vector<BDD_ID> &functions) {
+  std::vector<BDD_ID> relations;
+  for (size_t i = 0; i < functions.size(); i++) {
+    relations.push_back(xnor2(next_states[i], functions[i]));
+  }
+  return relations;
+}
+
+void Reachability::clusterRelations(const std::vector<BDD_ID> &relations,
+                                    size_t first, size_t last,
+                                    std::vector<Cluster> &clustered) {
+  // Merge consecutive relations while the cluster stays within the threshold
+  auto begin = clustered.size();
+  for (size_t bit = first; bit < last; bit++) {
+    if (clustered.size() > begin) {
+      auto merged = and2(clustered.back().relation, relations[bit]);
+      if (nodeCount(merged) <= cluster_threshold) {
+        clustered.back().relation = merged;
+        clustered.back().last = bit + 1;
+        continue;
+      }
+    }
+    clustered.push_back({bit, bit + 1, relations[bit], {}});
+  }
+
+  for (auto cluster = clustered.begin() + begin; cluster != clustered.end();
+       cluster++) {
+    for (auto &var : findVars(cluster->relation)) {
+      auto position = var < state_position.size() ? state_position[var] : -1;
+      if (position >= 0 ||
+          std::find(inputs.begin(), inputs.end(), var) != inputs.end()) {
+        cluster->support.push_back(var);
+      }
+    }
+  }
+}
+
+void Reachability::buildPartition(const std::vector<BDD_ID> &relations,
+                                  const std::vector<bool> &changed) {
+  std::vector<Cluster> new_partition;
+  if (partition.empty() || relations.empty() ||
+      std::all_of(changed.begin(), changed.end(), [](bool c) { return c; })) {
+    clusterRelations(relations, 0, relations.size(), new_partition);
+  } else {
+    for (auto &cluster : partition) {
+      if (std::any_of(changed.begin() + cluster.first,
+                      changed.begin() + cluster.last,
+                      [](bool c) { return c; })) {
+        clusterRelations(relations, cluster.first, cluster.last,
+                         new_partition);
+      } else {
+        new_partition.push_back(cluster);
+      }
+    }
+  }
+
+  // Number of clusters each state and input variable occurs in
+  std::map<BDD_ID, size_t> occurrences;
+  for (auto &cluster : new_partition) {
+    for (auto &var : cluster.support) occurrences[var]++;
+  }
+
+  std::vector<BDD_ID> new_quantify_first;
+  for (auto &var : states) {
+    if (!occurrences.count(var)) new_quantify_first.push_back(var);
+  }
+  for (auto &var : inputs) {
+    if (!occurrences.count(var)) new_quantify_first.push_back(var);
+  }
+
+  // Greedy ordering: prefer the cluster after which the most variables can
+  // be quantified, then the one adding the fewest variables to the product
+  std::vector<BDD_ID> new_clusters;
+  std::vector<std::vector<BDD_ID>> new_quantify_after;
+  std::vector<bool> scheduled(new_partition.size(), false);
+  std::set<BDD_ID> live;
+  for (size_t step = 0; step < new_partition.size(); step++) {
+    size_t best = new_partition.size(), best_quantified = 0, best_added = 0;
+    for (size_t j = 0; j < new_partition.size(); j++) {
+      if (scheduled[j]) continue;
+      size_t quantified = 0, added = 0;
+      for (auto &var : new_partition[j].support) {
+        if (occurrences[var] == 1) {
+          quantified++;
+        } else if (!live.count(var)) {
+          added++;
+        }
+      }
+      if (best == new_partition.size() || quantified > best_quantified ||
+          (quantified == best_quantified && added < best_added)) {
+        best = j;
+        best_quantified = quantified;
+        best_added = added;
+      }
+    }
+
+    scheduled[best] = true;
+    new_clusters.push_back(new_partition[best].relation);
+    new_quantify_after.emplace_back();
+    for (auto &var : new_partition[best].support) {
+      if (--occurrences[var] == 0) {
+        live.erase(var);
+        new_quantify_after.back().push_back(var);
+      } else {
+        live.insert(var);
+      }
+    }
   }
+
+  spdlog::debug("transition relation: {} clusters", new_clusters.size());
+  partition = new_partition;
+  clusters = new_clusters;
+  quantify_after = new_quantify_after;
+  quantify_first = new_quantify_first;
+}
+
+void Reachability::setInitState(const std::vector<bool> &stateVector) {
+  checkStateVector(stateVector);
+
+  // Compute Characteristic Function for Initial State (CS0)
+  auto new_cs0 = stateCube(stateVector);
+
+  init_state = stateVector;
+  setInitStates(new_cs0);
+}
+
+void Reachability::setInitStates(const BDD_ID &characteristic) {
+  checkStateSet(characteristic, "set of initial states");
+  if (characteristic == cs0) return;
+
+  cs0 = characteristic;
+  invalidateRings();
+}
+
+Reachability::Quantification::Quantification(
+    const std::vector<BDD_ID> &vars) {
+  if (vars.empty()) return;
+  quantified.assign(*std::max_element(vars.begin(), vars.end()) + 1, false);
+  for (auto &var : vars) quantified[var] = true;
 }
 
 BDD_ID Reachability::existential_quantification(const BDD_ID &f,
                                                 const std::vector<BDD_ID> &v) {
-  auto temp = f;
-  for (int64_t i = v.size() - 1; i >= 0; i--) {
-    temp = or2(coFactorTrue(temp, v[i]), coFactorFalse(temp, v[i]));
+  Quantification q(v);
+  return exists(f, q);
+}
+
+BDD_ID Reachability::exists(const BDD_ID &f, Quantification &q) {
+  auto node = getNode(f);
+  if (node->isConstant() || q.below(node->top)) return f;
+
+  auto cached = q.exists.find(f);
+  if (cached != q.exists.end()) return cached->second;
+
+  auto high = exists(node->high, q);
+  BDD_ID result;
+  if (q.quantified[node->top]) {
+    result = high == True() ? True() : or2(high, exists(node->low, q));
+  } else {
+    result = ite(node->top, high, exists(node->low, q));
   }
-  return temp;
+
+  q.exists.emplace(f, result);
+  return result;
+}
+
+BDD_ID Reachability::andExists(const BDD_ID &f, const BDD_ID &g,
+                               const std::vector<BDD_ID> &v) {
+  Quantification q(v);
+  return andExists(f, g, q);
+}
+
+BDD_ID Reachability::andExists(const BDD_ID &f, const BDD_ID &g,
+                               Quantification &q) {
+  if (f == False() || g == False()) return False();
+  if (f == True() || f == g) return exists(g, q);
+  if (g == True()) return exists(f, q);
+
+  auto f_node = getNode(f);
+  auto g_node = getNode(g);
+  auto top = std::min(f_node->top, g_node->top);
+  if (q.below(top)) return and2(f, g);
+
+  std::pair<BDD_ID, BDD_ID> key = std::minmax(f, g);
+  auto cached = q.and_exists.find(key);
+  if (cached != q.and_exists.end()) return cached->second;
+
+  auto f_high = f_node->top == top ? f_node->high : f;
+  auto f_low = f_node->top == top ? f_node->low : f;
+  auto g_high = g_node->top == top ? g_node->high : g;
+  auto g_low = g_node->top == top ? g_node->low : g;
+
+  auto high = andExists(f_high, g_high, q);
+  BDD_ID result;
+  if (q.quantified[top]) {
+    result =
+        high == True() ? True() : or2(high, andExists(f_low, g_low, q));
+  } else {
+    result = ite(top, high, andExists(f_low, g_low, q));
+  }
+
+  q.and_exists.emplace(key, result);
+  return result;
+}
+
+BDD_ID Reachability::constrain(const BDD_ID &f, const BDD_ID &c,
+                                PairCache &cache) {
+  if (c == True() || isConstant(f)) return f;
+  if (c == False()) return False();
+  if (f == c) return True();
+
+  auto cached = cache.find({f, c});
+  if (cached != cache.end()) return cached->second;
+
+  auto f_node = getNode(f);
+  auto c_node = getNode(c);
+  auto top = std::min(f_node->top, c_node->top);
+  auto f_high = f_node->top == top ? f_node->high : f;
+  auto f_low = f_node->top == top ? f_node->low : f;
+  auto c_high = c_node->top == top ? c_node->high : c;
+  auto c_low = c_node->top == top ? c_node->low : c;
+
+  // Outside of c, f takes the value of the other branch
+  BDD_ID result;
+  if (c_high == False()) {
+    result = constrain(f_low, c_low, cache);
+  } else if (c_low == False()) {
+    result = constrain(f_high, c_high, cache);
+  } else {
+    result = ite(top, constrain(f_high, c_high, cache),
+                 constrain(f_low, c_low, cache));
+  }
+
+  cache.emplace(std::make_pair(f, c), result);
+  return result;
+}
+
+BDD_ID Reachability::range(const std::vector<BDD_ID> &functions,
+                           size_t first, PairCache &constrained,
+                           std::map<std::vector<BDD_ID>, BDD_ID> &ranges) {
+  if (first == functions.size()) return True();
+
+  std::vector<BDD_ID> remaining(functions.begin() + first, functions.end());
+  auto cached = ranges.find(remaining);
+  if (cached != ranges.end()) return cached->second;
+
+  // A constant output fixes its state bit, any other output can be 0 or 1
+  auto f = functions[first];
+  BDD_ID result;
+  if (isConstant(f)) {
+    result = and2(xnor2(states[first], f),
+                  range(functions, first + 1, constrained, ranges));
+  } else {
+    auto onset = functions, offset = functions;
+    auto not_f = neg(f);
+    for (size_t i = first + 1; i < functions.size(); i++) {
+      onset[i] = constrain(functions[i], f, constrained);
+      offset[i] = constrain(functions[i], not_f, constrained);
+    }
+    result = ite(states[first], range(onset, first + 1, constrained, ranges),
+                 range(offset, first + 1, constrained, ranges));
+  }
+
+  ranges.emplace(std::move(remaining), result);
+  return result;
 }
 
 BDD_ID Reachability::restrict(const BDD_ID &f, const std::vector<bool> &k,
@@ -124,16 +1127,18 @@ BDD_ID Reachability::restrict(const BDD_ID &f, const std::vector<bool> &k,
   return temp;
 }
 
-bool Reachability::test_reachability(const BDD_ID &cr,
-                                     const std::vector<bool> &stateVector) {
-  auto result = restrict(cr, stateVector, states);
-
-  spdlog::debug(
-      "\n  incoming cr:             {}"
-      "\n  restrict cr on states:   {}",
-      cr, result);
-
-  return result == True();
+bool Reachability::contains(const BDD_ID &set,
+                            const std::vector<bool> &stateVector) {
+  auto node = getNode(set);
+  while (!node->isConstant()) {
+    auto position =
+        node->top < state_position.size() ? state_position[node->top] : -1;
+    if (position < 0) {
+      throw std::logic_error(">>> Set depends on non-state variables! <<<");
+    }
+    node = getNode(stateVector[position] ? node->high : node->low);
+  }
+  return node->id == True();
 }
 
 }  // namespace ClassProject
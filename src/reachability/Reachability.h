@@ -1,14 +1,127 @@
 #ifndef VDSPROJECT_REACHABILITY_H
 #define VDSPROJECT_REACHABILITY_H
 
+#include <boost/multiprecision/cpp_int.hpp>
+#include <functional>
+#include <map>
+#include <memory>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../Manager.h"
+#include "BoundedModelChecker.h"
+#include "ExplicitSearch.h"
+#include "FixpointTelemetry.h"
 #include "ReachabilityInterface.h"
 
 namespace ClassProject {
 
+/**
+ * Where the Reachability constructor places the input variables in the
+ * variable order
+ */
+enum class VariableOrder {
+  /// After all state variables
+  InputsLast,
+  /// Before all state variables
+  InputsFirst,
+  /// At the positions given in OrderingPolicy::input_positions
+  Custom
+};
+
+/**
+ * Variable order of a state machine. Each state variable s_i is always
+ * directly followed by its next state variable s_i'; the manager never
+ * reorders variables, so the pairs stay adjacent.
+ */
+struct OrderingPolicy {
+  VariableOrder order = VariableOrder::InputsLast;
+  /// Custom order only: number of state bits placed before each input
+  std::vector<unsigned int> input_positions;
+};
+
+/**
+ * How Reachability computes the image of a set of states
+ */
+enum class ImageEngine {
+  /// Relational product with the partitioned transition relation
+  Relation,
+  /// Range of the transition functions constrained to the set, the
+  /// transition relation is never built
+  Functions
+};
+
+/**
+ * How isReachable searches for a single target state
+ */
+enum class SearchMode {
+  /// Onion rings from the initial state until the target appears
+  Forward,
+  /// Preimages from the target until the initial state appears
+  Backward,
+  /// Extend the smaller of both frontiers until they meet
+  Bidirectional
+};
+
+/**
+ * How stateDistance and isReachable explore the state space
+ */
+enum class Exploration {
+  /// Explicit for small state machines searched forward, else symbolic
+  Automatic,
+  /// Onion rings, backward search or iterative squaring with BDDs
+  Symbolic,
+  /// Breadth-first search over single states, transition functions are
+  /// evaluated for 64 state and input combinations at once
+  Explicit,
+  /// SAT based bounded model checking up to Reachability::bound() steps,
+  /// BoundReached is thrown for states not found within the bound
+  Bounded
+};
+
+/**
+ * Thrown by bounded model checking if a state is not reached within the
+ * bound. The state may still be reachable in more steps, so neither
+ * answer is proven.
+ */
+class BoundReached : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+/**
+ * Path through the state machine. inputs[k] is applied in states[k] and
+ * leads to states[k + 1], so there is one input vector less than states.
+ */
+struct Trace {
+  std::vector<std::vector<bool>> states;
+  std::vector<std::vector<bool>> inputs;
+};
+
+/**
+ * Outcome of Reachability::checkInvariant
+ */
+struct InvariantResult {
+  bool holds;
+  /// Distance of the closest violating state, or the depth of the fixpoint
+  /// if the invariant holds
+  int depth;
+  /// Shortest trace to a violating state, if one was requested
+  Trace witness;
+};
+
+/**
+ * Value of a state bit in a cube
+ */
+enum class CubeValue : uint8_t { False, True, DontCare };
+
+/**
+ * Set of states with the given bits fixed, one entry per state bit
+ */
+using StateCube = std::vector<CubeValue>;
+
 class Reachability : public ReachabilityInterface {
  private:
   std::vector<BDD_ID> states;
@@ -16,10 +129,165 @@ class Reachability : public ReachabilityInterface {
   std::vector<BDD_ID> next_states;
   std::vector<bool> init_state;
   std::vector<BDD_ID> transitionFunctions;
-  BDD_ID tau;
   BDD_ID cs0;
 
+  /**
+   * Per-bit transition relations s_i' == f_i. A relation is only rebuilt
+   * when the transition function of its bit changes.
+   */
+  std::vector<BDD_ID> relations;
+
+  /**
+   * Conjunction of the relations of bits [first, last) with the state and
+   * input variables it depends on
+   */
+  struct Cluster {
+    size_t first;
+    size_t last;
+    BDD_ID relation;
+    std::vector<BDD_ID> support;
+  };
+
+  /**
+   * Conjunctively partitioned transition relation in bit order. Each cluster
+   * stays below cluster_threshold nodes unless a single relation is already
+   * larger. Only clusters containing a changed bit are rebuilt.
+   */
+  std::vector<Cluster> partition;
+
+  /**
+   * Relations of the partition in the order image() conjoins them
+   */
+  std::vector<BDD_ID> clusters;
+  size_t cluster_threshold = DEFAULT_CLUSTER_THRESHOLD;
+
+  /**
+   * Early quantification schedule: quantify_after[j] holds the state and
+   * input variables no later cluster depends on, so they are quantified as
+   * soon as clusters[j] is conjoined. quantify_first holds the variables no
+   * cluster depends on at all.
+   */
+  std::vector<std::vector<BDD_ID>> quantify_after;
+  std::vector<BDD_ID> quantify_first;
+
+  ImageEngine image_engine = ImageEngine::Relation;
+  SearchMode search_mode = SearchMode::Forward;
+  unsigned int query_threads;
+
+  /**
+   * Conjunction of s_i == s_i' over all state bits, used to rename an image
+   * over next_states back to states. Built once in the constructor.
+   */
+  BDD_ID identity;
+
+  /**
+   * Onion rings of the forward traversal: rings[d] holds the states at
+   * distance exactly d, reached their union. The rings are extended lazily
+   * by queries and dropped when the initial state or the transition
+   * functions change.
+   */
+  std::vector<BDD_ID> rings;
+  BDD_ID reached;
+  bool rings_complete = false;
+
+  /**
+   * Iterative squaring: closures[j] relates each state over states to the
+   * states over next_states reachable from it in at most 2^j steps. Once
+   * closures_complete is set, the last closure is the reflexive transitive
+   * closure. The middle state variables needed to compose two closures are
+   * created on first use. squared_reached is only meaningful once
+   * squared_reached_valid is set, after the reachable states have been
+   * derived from the closure.
+   */
+  bool iterative_squaring = false;
+  std::vector<BDD_ID> middle_states;
+  std::vector<BDD_ID> closures;
+  bool closures_complete = false;
+  BDD_ID squared_reached;
+  bool squared_reached_valid = false;
+
+  /**
+   * Machine by machine over-approximation: the state bits are split into
+   * blocks of approximation_block bits, consecutive blocks sharing
+   * approximation_overlap bits. A block size of zero disables it.
+   * approximation is only meaningful while approximation_valid is set.
+   */
+  size_t approximation_block = 0;
+  size_t approximation_overlap = 0;
+  BDD_ID approximation;
+  bool approximation_valid = false;
+
+  /**
+   * Explicit-state search, created on first use and dropped together with
+   * the onion rings
+   */
+  Exploration exploration_mode = Exploration::Automatic;
+  std::unique_ptr<ExplicitSearch> explicit_search;
+
+  /**
+   * Unrolled transition functions for bounded model checking, created on
+   * first use and dropped together with the onion rings
+   */
+  unsigned int bmc_bound = DEFAULT_BOUND;
+  std::unique_ptr<BoundedModelChecker> bounded_checker;
+
+  /**
+   * Onion rings recorded while record_telemetry is set
+   */
+  bool record_telemetry = false;
+  bool stats_before_telemetry = false;  ///< Restored when telemetry stops
+  FixpointTelemetry telemetry_log;
+
+  /**
+   * Position of each state variable in states, indexed by BDD_ID, -1 for
+   * any other variable
+   */
+  std::vector<int> state_position;
+
+  using PairCache = std::unordered_map<std::pair<BDD_ID, BDD_ID>, BDD_ID,
+                                      boost::hash<std::pair<BDD_ID, BDD_ID>>>;
+
+  /**
+   * Variables of one quantification as a bitmap indexed by BDD_ID, with the
+   * results computed so far
+   */
+  struct Quantification {
+    explicit Quantification(const std::vector<BDD_ID> &vars);
+
+    std::vector<bool> quantified;
+    std::unordered_map<BDD_ID, BDD_ID> exists;
+    PairCache and_exists;
+
+    /**
+     * True if var is ordered below every quantified variable
+     */
+    bool below(const BDD_ID &var) const { return var >= quantified.size(); }
+  };
+
  public:
+  /**
+   * Default node limit of a transition relation cluster
+   */
+  static constexpr size_t DEFAULT_CLUSTER_THRESHOLD = 5000;
+
+  /**
+   * Widest state machine Exploration::Automatic searches explicitly: state
+   * bits, and state plus input bits
+   */
+  static constexpr unsigned int EXPLICIT_STATE_BITS = 24;
+  static constexpr unsigned int EXPLICIT_COMBINATION_BITS = 28;
+
+  /**
+   * Widest state machine Exploration::Explicit accepts, per state and input
+   * bits. The visited set alone takes 32 MiB at this width.
+   */
+  static constexpr unsigned int EXPLICIT_MAX_BITS = 28;
+
+  /**
+   * Default number of steps bounded model checking unrolls
+   */
+  static constexpr unsigned int DEFAULT_BOUND = 20;
+
   /**
    * The constructor initializes a default state machine with the given number
    * of variables. All state variables should be created within the constructor.
@@ -30,9 +298,32 @@ class Reachability : public ReachabilityInterface {
    *
    * @param stateSize vector specifying the number of bits
    * @param inputSize number of boolean input bits, defaults to zero
-   * @throws std::runtime_error if stateSize is zero
+   * @param policy placement of the inputs in the variable order, defaults to
+   * after all state bits
+   * @throws std::runtime_error if stateSize is zero or a custom order does
+   * not place every input at a valid position
    */
-  explicit Reachability(unsigned int stateSize, unsigned int inputSize = 0);
+  explicit Reachability(unsigned int stateSize, unsigned int inputSize = 0,
+                        const OrderingPolicy &policy = {});
+
+  /**
+   * Same as above, but the state machine lives in the node table of an
+   * existing manager instead of a private one. Its variables are created
+   * below all variables of the manager. BDDs are shared with the manager
+   * and every other state machine attached to it, so common functions are
+   * built only once and can be compared by ID.
+   *
+   * @param manager Manager to share the nodes with, it may be destroyed
+   * before the state machine
+   * @param stateSize vector specifying the number of bits
+   * @param inputSize number of boolean input bits, defaults to zero
+   * @param policy placement of the inputs in the variable order, defaults to
+   * after all state bits
+   * @throws std::runtime_error if stateSize is zero or a custom order does
+   * not place every input at a valid position
+   */
+  Reachability(Manager &manager, unsigned int stateSize,
+               unsigned int inputSize = 0, const OrderingPolicy &policy = {});
 
   inline const std::vector<BDD_ID> &getStates() const override {
     return states;
@@ -49,7 +340,304 @@ class Reachability : public ReachabilityInterface {
       const std::vector<BDD_ID> &transitionFunctions) override;
   void setInitState(const std::vector<bool> &stateVector) override;
 
+  /**
+   * @brief Set a whole set of initial states
+   *
+   * All initial states are explored in one traversal, distances are
+   * measured from the closest one. Cached results are kept if the set does
+   * not change.
+   *
+   * @param characteristic BDD_ID Characteristic function over the state
+   * variables
+   * @throws std::runtime_error if the ID is unknown or the function depends
+   * on other variables
+   */
+  void setInitStates(const BDD_ID &characteristic);
+
+  /**
+   * @brief Set the node limit of a transition relation cluster
+   *
+   * Per-bit relations are merged into a cluster while the cluster stays
+   * within the limit. A limit of 1 keeps every relation in its own cluster,
+   * a huge limit builds the monolithic transition relation. The reachable
+   * states do not depend on the partition, so cached results are kept.
+   *
+   * @param threshold Maximum number of nodes of a cluster
+   */
+  void setClusterThreshold(size_t threshold);
+
+  inline size_t clusterThreshold() const { return cluster_threshold; }
+
+  /**
+   * @brief Number of clusters of the partitioned transition relation
+   *
+   * Zero while the Functions engine is selected, as no relation is built.
+   */
+  inline size_t clusterCount() const { return clusters.size(); }
+
+  /**
+   * @brief Select how images are computed
+   *
+   * Switching to the Relation engine builds the partitioned transition
+   * relation if it does not exist yet. Both engines compute the same
+   * images, so cached results are kept.
+   *
+   * @param engine Image engine to use from now on
+   */
+  void setImageEngine(ImageEngine engine);
+
+  inline ImageEngine imageEngine() const { return image_engine; }
+
+  /**
+   * @brief Select how isReachable searches
+   *
+   * Backward and bidirectional search stop as soon as the target is shown
+   * reachable, which is usually much earlier than the forward fixpoint for
+   * targets close to the initial state. Onion rings computed before are
+   * used by every mode, stateDistance always searches forward.
+   *
+   * @param mode Search mode to use from now on
+   */
+  void setSearchMode(SearchMode mode) { search_mode = mode; }
+
+  inline SearchMode searchMode() const { return search_mode; }
+
+  /**
+   * @brief Use iterative squaring for forward queries
+   *
+   * Instead of one image per step, the relation "reachable in at most k
+   * steps" is squared for k = 1, 2, 4, ... until it no longer changes, so
+   * deep state machines need a logarithmic number of fixpoint iterations.
+   * stateDistance then finds the distance by binary search over the
+   * closures. Each closure ranges over two copies of the state variables,
+   * so this pays off for deep machines with few state bits.
+   *
+   * @param enable True to answer stateDistance and forward isReachable
+   * queries from the closures
+   */
+  void setIterativeSquaring(bool enable) { iterative_squaring = enable; }
+
+  inline bool iterativeSquaring() const { return iterative_squaring; }
+
+  /**
+   * @brief Select how single states are searched
+   *
+   * Explicit search pays off below a few million states: it needs no BDD
+   * operations but visits every reachable state and input combination.
+   * Both explorations give the same distances. Automatic searches
+   * explicitly if the state machine is at most EXPLICIT_STATE_BITS and
+   * EXPLICIT_COMBINATION_BITS wide and neither backward search nor
+   * iterative squaring was selected. Transition functions depending on
+   * other variables than the states and inputs are always searched
+   * symbolically.
+   *
+   * Explicit search keeps one bit per state, 2^n / 8 bytes for n state
+   * bits (32 MiB at EXPLICIT_MAX_BITS), and evaluates all 2^m input
+   * combinations of every reachable state for m input bits.
+   *
+   * @param mode Exploration to use from now on
+   * @throws std::runtime_error if Explicit is selected for more than
+   * EXPLICIT_MAX_BITS state or input bits
+   */
+  void setExploration(Exploration mode);
+
+  inline Exploration exploration() const { return exploration_mode; }
+
+  /**
+   * @brief Set the depth of bounded model checking
+   *
+   * Bounded model checking unrolls the transition functions into CNF and
+   * never builds a BDD. Besides Exploration::Bounded, it takes over
+   * stateDistance and isReachable queries whose symbolic search hits the
+   * node limit of the manager: a state found within the bound is answered,
+   * otherwise ResourceExhausted is passed on. A bound of 0 disables this
+   * fallback, and so do transition functions that depend on other variables
+   * than the states and inputs.
+   *
+   * A state not found within the bound is only known to be further away.
+   * Exploration::Bounded then throws BoundReached and the fallback passes on
+   * ResourceExhausted, unless the bound is at least 2^n - 1 for n state
+   * bits: no shortest path is longer, so the state is unreachable and -1 or
+   * false is returned.
+   *
+   * @param depth Largest distance bounded model checking looks for
+   */
+  void setBound(unsigned int depth) { bmc_bound = depth; }
+
+  inline unsigned int bound() const { return bmc_bound; }
+
+  /**
+   * @brief Record every iteration of the forward traversal
+   *
+   * Each onion ring adds one FixpointIteration with the sizes of the new
+   * ring and of the reached states, the image time, the unique table size
+   * and the computed table hit rate. The hit rate is taken from the
+   * statistics of the manager, so enabling telemetry enables them too.
+   * Stopping restores whether statistics were enabled before.
+   *
+   * @param enable True to start recording, False to stop
+   */
+  void recordTelemetry(bool enable = true);
+
+  /**
+   * @brief Iterations recorded since the last resetTelemetry()
+   */
+  const FixpointTelemetry &telemetry() const { return telemetry_log; }
+  void resetTelemetry() { telemetry_log = FixpointTelemetry(); }
+
+  /**
+   * @brief Reject unreachable states with an over-approximation first
+   *
+   * Each block of state bits is traversed as a sub-machine of its own, the
+   * other state bits are only constrained by the reachable states of their
+   * blocks. The conjunction of the blocks contains every reachable state,
+   * so isReachable answers false for any state outside of it without an
+   * exact traversal. Other states are still searched exactly.
+   *
+   * @param block_size Number of state bits per sub-machine, 0 disables the
+   * approximation
+   * @param overlap Number of state bits shared by consecutive sub-machines
+   * @throws std::runtime_error if the overlap is not smaller than the block
+   * size
+   */
+  void setApproximation(size_t block_size, size_t overlap = 1);
+
+  inline size_t approximationBlock() const { return approximation_block; }
+
+  /**
+   * @brief Over-approximation of the reachable states
+   *
+   * Computed with the blocks set by setApproximation, or with a single
+   * block of all state bits, in which case it is exact.
+   *
+   * @return BDD_ID Characteristic function over the state variables
+   */
+  BDD_ID overApproximation();
+
+  /**
+   * @brief All reachable states
+   *
+   * Runs the traversal to its fixpoint, with iterative squaring if enabled.
+   *
+   * @return BDD_ID Characteristic function over the state variables
+   */
+  BDD_ID reachableStates();
+
+  /**
+   * @brief Check that a property holds in every reachable state
+   *
+   * Tests each onion ring as soon as it is computed and stops at the first
+   * one containing a violating state, so shallow bugs are found without
+   * computing the reachable states.
+   *
+   * @param property BDD_ID Characteristic function over the state variables
+   * @param witness bool True to compute a trace to a violating state
+   * @return InvariantResult Whether the invariant holds and at which depth
+   * @throws std::runtime_error if the property depends on other variables
+   */
+  InvariantResult checkInvariant(const BDD_ID &property, bool witness = false);
+
+  /**
+   * @brief Exact number of reachable states
+   *
+   * Counts the minterms of the reachable states over the state variables,
+   * memoized per node, so the count is linear in the size of the BDD.
+   *
+   * @return boost::multiprecision::cpp_int Number of reachable states
+   */
+  boost::multiprecision::cpp_int reachableStateCount();
+
+  /**
+   * Enumerates the disjoint cubes of a set of states, one page at a time.
+   * Nodes are never freed, so an enumerator stays valid while the state
+   * machine changes.
+   */
+  class CubeEnumerator {
+   public:
+    /**
+     * @brief Next cubes of the set
+     * @param page_size Maximum number of cubes to return
+     * @return std::vector<StateCube> Up to page_size cubes, empty once all
+     * cubes were returned
+     */
+    std::vector<StateCube> nextPage(size_t page_size);
+
+    /**
+     * @brief True once every cube was returned
+     */
+    bool done() const { return pending.empty(); }
+
+   private:
+    friend class Reachability;
+    CubeEnumerator(Reachability &fsm, const BDD_ID &set);
+
+    Reachability &fsm;
+    /// Paths still to follow: the node they reached and the bits fixed on
+    /// the way there
+    std::vector<std::pair<BDD_ID, StateCube>> pending;
+  };
+
+  /**
+   * @brief Enumerate the reachable states as cubes
+   * @return CubeEnumerator Enumerator over the reachable states
+   */
+  CubeEnumerator enumerateReachableStates();
+
+  /**
+   * @brief Reachability of many states at once
+   *
+   * Computes the reachable states once, then evaluates all states against
+   * them in parallel.
+   *
+   * @param stateVectors std::vector<std::vector<bool>> States to test
+   * @return std::vector<bool> True for each reachable state
+   * @throws std::runtime_error if a size does not match the number of state
+   * bits
+   */
+  std::vector<bool> areReachable(
+      const std::vector<std::vector<bool>> &stateVectors);
+
+  /**
+   * @brief Distances of many states at once
+   *
+   * Computes all onion rings once, then evaluates all states against them
+   * in parallel.
+   *
+   * @param stateVectors std::vector<std::vector<bool>> States to test
+   * @return std::vector<int> Distance of each state, -1 if unreachable
+   * @throws std::runtime_error if a size does not match the number of state
+   * bits
+   */
+  std::vector<int> stateDistances(
+      const std::vector<std::vector<bool>> &stateVectors);
+
+  /**
+   * @brief Shortest path from the initial state to a state
+   *
+   * Walks the onion rings backwards: the predecessor of each state on the
+   * path is picked from the previous ring together with an input that leads
+   * to it. Inputs the transition does not depend on are false.
+   *
+   * @param stateVector std::vector<bool> Target state
+   * @return Trace Shortest trace, without any states if the target is
+   * unreachable
+   * @throws std::runtime_error if size does not match with number of state
+   * bits
+   */
+  Trace traceTo(const std::vector<bool> &stateVector);
+
+  /**
+   * @brief Set the number of threads answering batch queries
+   * @param threads Number of threads, 0 uses the hardware concurrency
+   */
+  void setQueryThreads(unsigned int threads);
+
+  inline unsigned int queryThreads() const { return query_threads; }
+
  private:
+  Reachability(std::shared_ptr<NodeTable> table, unsigned int stateSize,
+               unsigned int inputSize, const OrderingPolicy &policy);
+
   /**
    * @brief Existential quantification operator
    * @param f BDD_ID Characteristic function
@@ -59,6 +647,82 @@ class Reachability : public ReachabilityInterface {
   BDD_ID existential_quantification(const BDD_ID &f,
                                     const std::vector<BDD_ID> &v);
 
+  /**
+   * @brief Relational product
+   *
+   * Computes the existential quantification of f AND g without building the
+   * conjunction first.
+   *
+   * @param f BDD_ID First operand
+   * @param g BDD_ID Second operand
+   * @param v std::vector<BDD_ID> Vector of variables to quantify
+   * @return BDD_ID Quantified conjunction
+   */
+  BDD_ID andExists(const BDD_ID &f, const BDD_ID &g,
+                   const std::vector<BDD_ID> &v);
+
+  BDD_ID exists(const BDD_ID &f, Quantification &q);
+  BDD_ID andExists(const BDD_ID &f, const BDD_ID &g, Quantification &q);
+
+  /**
+   * @brief Generalized cofactor of f w.r.t. c
+   *
+   * Coudert and Madre's constrain operator: agrees with f wherever c holds
+   * and maps every other point to a nearby point of c. Applying it to all
+   * transition functions keeps their range equal to the image of c.
+   *
+   * @param f BDD_ID Function to constrain
+   * @param c BDD_ID Care set, must not be False
+   * @param cache Results computed so far
+   * @return BDD_ID Constrained function
+   */
+  BDD_ID constrain(const BDD_ID &f, const BDD_ID &c, PairCache &cache);
+
+  /**
+   * @brief Range of a vector of functions by recursive output splitting
+   *
+   * The range is built over states[first..], one state variable per
+   * function, so no next state variables are involved. Each split
+   * constrains the remaining functions to the onset and the offset of the
+   * first one.
+   *
+   * @param functions std::vector<BDD_ID> Functions, one per state bit
+   * @param first size_t Index of the first function still to split on
+   * @param constrained Constrain results computed so far
+   * @param ranges Ranges computed so far, by remaining functions
+   * @return BDD_ID Characteristic function of the range
+   */
+  BDD_ID range(const std::vector<BDD_ID> &functions, size_t first,
+               PairCache &constrained,
+               std::map<std::vector<BDD_ID>, BDD_ID> &ranges);
+
+  /**
+   * @brief Per-bit transition relations s_i' == f_i
+   */
+  std::vector<BDD_ID> buildRelations(const std::vector<BDD_ID> &functions);
+
+  /**
+   * @brief Cluster the per-bit relations and schedule the quantification
+   *
+   * Consecutive relations are merged greedily up to cluster_threshold nodes.
+   * Clusters without a changed bit are kept as they are, if every bit
+   * changed all relations are clustered anew. The clusters are then ordered
+   * IWLS95 style: the next cluster is the one whose conjunction lets the
+   * most variables be quantified, ties go to the one adding the fewest new
+   * variables to the product.
+   *
+   * @param relations std::vector<BDD_ID> Per-bit transition relations
+   * @param changed std::vector<bool> Bits whose relation changed
+   */
+  void buildPartition(const std::vector<BDD_ID> &relations,
+                      const std::vector<bool> &changed);
+
+  /**
+   * @brief Greedily cluster the relations of bits [first, last)
+   */
+  void clusterRelations(const std::vector<BDD_ID> &relations, size_t first,
+                        size_t last, std::vector<Cluster> &clustered);
+
   /**
    * @brief Restrict operator
    *
@@ -88,14 +752,208 @@ class Reachability : public ReachabilityInterface {
       const BDD_ID &f);
 
   /**
-   * @brief Test reachability of a state
+   * @brief Test whether a state is in a set of states
+   *
+   * Follows the single path the state selects through the BDD, so no nodes
+   * are created.
    *
-   * @param cr BDD_ID Characteristic function to restrict
-   * @param stateVector std::vector<bool> State to test reachability
-   * @return bool True if the state is reachable, False otherwise
+   * @param set BDD_ID Characteristic function over the state variables
+   * @param stateVector std::vector<bool> State to test
+   * @return bool True if the state is in the set, False otherwise
+   */
+  bool contains(const BDD_ID &set, const std::vector<bool> &stateVector);
+
+  /**
+   * @brief Image of a set of states, computed by the selected engine
+   * @param frontier BDD_ID Characteristic function over the state variables
+   * @return BDD_ID Successor states, over the state variables
+   */
+  BDD_ID image(const BDD_ID &frontier);
+
+  /**
+   * @brief Preimage of a set of states
+   *
+   * Substitutes every state variable of the set by its transition function
+   * and quantifies the inputs, so no relation is needed.
+   *
+   * @param set BDD_ID Characteristic function over the state variables
+   * @return BDD_ID Predecessor states, over the state variables
+   */
+  BDD_ID preimage(const BDD_ID &set);
+
+  /**
+   * @brief Substitute every state variable by its transition function
+   */
+  BDD_ID composeStates(const BDD_ID &f);
+
+  /**
+   * @brief Substitute variables by functions
+   * @param f BDD_ID Function to substitute in
+   * @param from std::vector<BDD_ID> Variables to replace
+   * @param to std::vector<BDD_ID> Replacement of each variable
+   * @return BDD_ID f with all replacements made at once
+   */
+  BDD_ID rename(const BDD_ID &f, const std::vector<BDD_ID> &from,
+                const std::vector<BDD_ID> &to);
+
+  BDD_ID compose(const BDD_ID &f,
+                 const std::unordered_map<BDD_ID, BDD_ID> &substitution,
+                 std::unordered_map<BDD_ID, BDD_ID> &cache);
+
+  /**
+   * @brief Search for a target state from the target backwards
+   *
+   * In bidirectional mode the onion rings are extended as well, whichever
+   * frontier is smaller goes next.
+   *
+   * @param stateVector std::vector<bool> Target state
+   * @return bool True if the target is reachable
+   */
+  bool searchBackward(const std::vector<bool> &stateVector);
+
+  /**
+   * @brief Pick one satisfying assignment of f
+   *
+   * Follows the low branch wherever it does not lead to False. Variables
+   * not on the path keep their value.
+   *
+   * @param f BDD_ID Function over state and input variables, not False
+   * @param stateVector std::vector<bool> Receives the state bits
+   * @param inputVector std::vector<bool> Receives the input bits
+   */
+  void pickAssignment(const BDD_ID &f, std::vector<bool> &stateVector,
+                      std::vector<bool> &inputVector);
+
+  /**
+   * @brief Number of states in a set
+   */
+  boost::multiprecision::cpp_int stateCount(const BDD_ID &set);
+
+  /**
+   * @brief Number of state assignments below positions[f] satisfying f
+   */
+  boost::multiprecision::cpp_int countStates(
+      const BDD_ID &f,
+      std::unordered_map<BDD_ID, boost::multiprecision::cpp_int> &counts);
+
+  /**
+   * @brief Position of the top variable of f in states, states.size() for
+   * the constants
+   */
+  size_t statePosition(const BDD_ID &f);
+
+  /**
+   * @brief Characteristic function of a single state
+   */
+  BDD_ID stateCube(const std::vector<bool> &stateVector);
+
+  /**
+   * @brief Add the next onion ring
+   *
+   * The first call adds the initial states. Later calls image only the last
+   * ring and keep the states that were not reached before.
+   *
+   * @return bool False if the fixpoint was already reached
+   */
+  bool expandRings();
+
+  /**
+   * @brief stateDistance from the onion rings, extending them as needed
+   */
+  int ringDistance(const std::vector<bool> &stateVector);
+
+  /**
+   * @brief Explicit-state search for the current state machine
+   * @return ExplicitSearch* Search to use, nullptr to search symbolically
+   */
+  ExplicitSearch *explicitSearch();
+
+  /**
+   * @brief Compile the transition functions for ExplicitSearch
+   * @param functions std::vector<BDD_ID> Functions to compile, one output
+   * each
+   * @param compiled CompiledFunctions Receives the program
+   * @return bool False if a function depends on other variables than the
+   * states and inputs
+   */
+  bool compileFunctions(const std::vector<BDD_ID> &functions,
+                        CompiledFunctions &compiled);
+
+  /**
+   * @brief Bounded model checker of the transition functions, built on the
+   * first call
+   * @return BoundedModelChecker* nullptr if a transition function depends
+   * on other variables than the states and inputs
+   */
+  BoundedModelChecker *boundedChecker();
+
+  /**
+   * @brief stateDistance by bounded model checking
+   * @throws std::runtime_error if a transition function depends on other
+   * variables than the states and inputs
+   * @throws BoundReached if the state is not found within the bound and
+   * the bound does not cover all states
+   */
+  int boundedDistance(const std::vector<bool> &stateVector);
+
+  /**
+   * @brief Answer a query whose symbolic search ran out of nodes
+   *
+   * Must be called from the handler of exhausted, which is rethrown unless
+   * bounded model checking answers the query: the state is found, or the
+   * bound covers all states and it is proven unreachable.
+   *
+   * @return int Distance of the state, -1 if it is unreachable
+   */
+  int boundedFallback(const std::vector<bool> &stateVector,
+                      const ResourceExhausted &exhausted);
+
+  /**
+   * @brief Append the states of f as integers, state bit i at bit i
+   */
+  void collectStates(const BDD_ID &f, size_t position, uint32_t state,
+                     std::vector<uint32_t> &collected);
+
+  /**
+   * @brief Run body(i) for i in [0, count) on up to query_threads threads
+   *
+   * Only used once the rings are complete: the BDDs are then only read, so
+   * the threads do not need to synchronize.
+   */
+  void parallelFor(size_t count, const std::function<void(size_t)> &body);
+
+  /**
+   * @brief Square the transition relation up to its transitive closure
+   */
+  void buildClosures();
+
+  /**
+   * @brief States reached from a set under a relation
+   * @param set BDD_ID Characteristic function over the state variables
+   * @param relation BDD_ID Relation over states and next_states
+   * @return BDD_ID Successor states, over the state variables
+   */
+  BDD_ID post(const BDD_ID &set, const BDD_ID &relation);
+
+  /**
+   * @brief stateDistance by binary search over the closures
+   */
+  int squaredDistance(const std::vector<bool> &stateVector);
+
+  /**
+   * @brief Drop the cached onion rings
+   */
+  void invalidateRings();
+
+  void checkStateVector(const std::vector<bool> &stateVector) const;
+
+  /**
+   * @brief Check that f is a known function over the state variables only
+   * @param f BDD_ID Function to check
+   * @param what std::string Name of f in the error message
+   * @throws std::runtime_error otherwise
    */
-  bool test_reachability(const BDD_ID &cr,
-                         const std::vector<bool> &stateVector);
+  void checkStateSet(const BDD_ID &f, const std::string &what);
 };
 
 }  // namespace ClassProject
@@ -12,6 +12,9 @@ namespace ClassProject {
 class ReachabilityInterface : public Manager {
  public:
   //   ReachabilityInterface() = delete;
+  ReachabilityInterface() = default;
+  explicit ReachabilityInterface(std::shared_ptr<NodeTable> table)
+      : Manager(std::move(table)) {}
   virtual ~ReachabilityInterface() = default;
 
   /**
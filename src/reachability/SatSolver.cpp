@@ -0,0 +1,287 @@
+#include "SatSolver.h"
+
+#include <algorithm>
+
+namespace ClassProject {
+
+uint32_t SatSolver::newVar() {
+  uint32_t var = assigns.size();
+  assigns.push_back(UNASSIGNED);
+  polarity.push_back(false);
+  levels.push_back(0);
+  reasons.push_back(NO_REASON);
+  activity.push_back(0);
+  heap_position.push_back(-1);
+  seen.push_back(false);
+  watches.resize(2 * assigns.size());
+  heapInsert(var);
+  return var;
+}
+
+void SatSolver::addClause(std::vector<Literal> clause) {
+  if (!ok) return;
+  backtrack(0);
+
+  // Drop duplicates and literals false at level 0, skip satisfied clauses
+  std::sort(clause.begin(), clause.end());
+  clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+  std::vector<Literal> kept;
+  for (size_t k = 0; k < clause.size(); k++) {
+    auto lit = clause[k];
+    if (valueOf(lit) == 1) return;
+    if (k + 1 < clause.size() && clause[k + 1] == negate(lit)) return;
+    if (valueOf(lit) == UNASSIGNED) kept.push_back(lit);
+  }
+
+  if (kept.empty()) {
+    ok = false;
+  } else if (kept.size() == 1) {
+    enqueue(kept[0], NO_REASON);
+    ok = propagate() == NO_REASON;
+  } else {
+    attach(std::move(kept));
+  }
+}
+
+uint32_t SatSolver::attach(std::vector<Literal> clause) {
+  uint32_t index = clauses.size();
+  watches[clause[0]].push_back(index);
+  watches[clause[1]].push_back(index);
+  clauses.push_back(std::move(clause));
+  return index;
+}
+
+void SatSolver::enqueue(Literal lit, uint32_t reason) {
+  auto var = variableOf(lit);
+  assigns[var] = !(lit & 1);
+  levels[var] = decisionLevel();
+  reasons[var] = reason;
+  trail.push_back(lit);
+}
+
+uint32_t SatSolver::propagate() {
+  while (propagated < trail.size()) {
+    auto falsified = negate(trail[propagated++]);
+    auto &watching = watches[falsified];
+
+    size_t kept = 0;
+    for (size_t w = 0; w < watching.size(); w++) {
+      auto index = watching[w];
+      auto &clause = clauses[index];
+
+      // Keep the false literal at position 1
+      if (clause[0] == falsified) std::swap(clause[0], clause[1]);
+      if (valueOf(clause[0]) == 1) {
+        watching[kept++] = index;
+        continue;
+      }
+
+      // Look for a new literal to watch
+      bool moved = false;
+      for (size_t k = 2; k < clause.size(); k++) {
+        if (valueOf(clause[k]) != 0) {
+          std::swap(clause[1], clause[k]);
+          watches[clause[1]].push_back(index);
+          moved = true;
+          break;
+        }
+      }
+      if (moved) continue;
+
+      watching[kept++] = index;
+      if (valueOf(clause[0]) == 0) {
+        // Conflict: keep the remaining watches
+        for (w++; w < watching.size(); w++) watching[kept++] = watching[w];
+        watching.resize(kept);
+        return index;
+      }
+      enqueue(clause[0], index);
+    }
+    watching.resize(kept);
+  }
+  return NO_REASON;
+}
+
+uint32_t SatSolver::analyze(uint32_t conflict, std::vector<Literal> &learnt) {
+  learnt.assign(1, 0);
+  size_t pending = 0;
+  Literal uip = 0;
+  auto position = trail.size();
+
+  // Resolve with the reasons of the current level until one literal of it
+  // is left. The first literal of a reason is the one it implied.
+  do {
+    const auto &clause = clauses[conflict];
+    for (size_t k = position == trail.size() ? 0 : 1; k < clause.size(); k++) {
+      auto var = variableOf(clause[k]);
+      if (seen[var] || levels[var] == 0) continue;
+
+      seen[var] = true;
+      bumpActivity(var);
+      if (levels[var] == decisionLevel()) {
+        pending++;
+      } else {
+        learnt.push_back(clause[k]);
+      }
+    }
+
+    while (!seen[variableOf(trail[--position])]) {
+    }
+    uip = trail[position];
+    conflict = reasons[variableOf(uip)];
+    seen[variableOf(uip)] = false;
+  } while (--pending > 0);
+  learnt[0] = negate(uip);
+
+  // The highest other level is the one to backtrack to, watch it second
+  uint32_t level = 0;
+  for (size_t k = 1; k < learnt.size(); k++) {
+    seen[variableOf(learnt[k])] = false;
+    if (levels[variableOf(learnt[k])] > level) {
+      level = levels[variableOf(learnt[k])];
+      std::swap(learnt[1], learnt[k]);
+    }
+  }
+  activity_increment *= 1.05;
+  return level;
+}
+
+void SatSolver::backtrack(uint32_t level) {
+  if (decisionLevel() <= level) return;
+
+  for (auto k = trail.size(); k > trail_limits[level]; k--) {
+    auto var = variableOf(trail[k - 1]);
+    polarity[var] = assigns[var];
+    assigns[var] = UNASSIGNED;
+    reasons[var] = NO_REASON;
+    heapInsert(var);
+  }
+  trail.resize(trail_limits[level]);
+  trail_limits.resize(level);
+  propagated = trail.size();
+}
+
+bool SatSolver::solve(const std::vector<Literal> &assumptions) {
+  if (!ok) return false;
+  backtrack(0);
+
+  size_t conflicts = 0;
+  double restart_limit = 100;
+  std::vector<Literal> learnt;
+  while (true) {
+    auto conflict = propagate();
+    if (conflict != NO_REASON) {
+      if (decisionLevel() == 0) {
+        ok = false;
+        return false;
+      }
+
+      auto level = analyze(conflict, learnt);
+      backtrack(level);
+      if (learnt.size() == 1) {
+        enqueue(learnt[0], NO_REASON);
+      } else {
+        enqueue(learnt[0], attach(learnt));
+      }
+      conflicts++;
+      continue;
+    }
+
+    if (conflicts >= restart_limit) {
+      backtrack(0);
+      conflicts = 0;
+      restart_limit *= 1.5;
+      continue;
+    }
+
+    // Assumptions are decided first, one level each
+    Literal decision = 0;
+    bool decided = false;
+    while (decisionLevel() < assumptions.size()) {
+      auto lit = assumptions[decisionLevel()];
+      if (valueOf(lit) == 0) {
+        backtrack(0);
+        return false;
+      }
+      trail_limits.push_back(trail.size());
+      if (valueOf(lit) == UNASSIGNED) {
+        decision = lit;
+        decided = true;
+        break;
+      }
+    }
+
+    while (!decided && !heap.empty()) {
+      auto var = heapPop();
+      if (assigns[var] != UNASSIGNED) continue;
+      trail_limits.push_back(trail.size());
+      decision = polarity[var] ? positive(var) : negative(var);
+      decided = true;
+    }
+
+    if (!decided) {
+      model.assign(assigns.begin(), assigns.end());
+      backtrack(0);
+      return true;
+    }
+    enqueue(decision, NO_REASON);
+  }
+}
+
+void SatSolver::bumpActivity(uint32_t var) {
+  activity[var] += activity_increment;
+  if (activity[var] > 1e100) {
+    for (auto &a : activity) a *= 1e-100;
+    activity_increment *= 1e-100;
+  }
+  if (heap_position[var] >= 0) heapUp(heap_position[var]);
+}
+
+void SatSolver::heapInsert(uint32_t var) {
+  if (heap_position[var] >= 0) return;
+  heap_position[var] = heap.size();
+  heap.push_back(var);
+  heapUp(heap.size() - 1);
+}
+
+uint32_t SatSolver::heapPop() {
+  auto var = heap.front();
+  heap.front() = heap.back();
+  heap_position[heap.front()] = 0;
+  heap.pop_back();
+  heap_position[var] = -1;
+  if (!heap.empty()) heapDown(0);
+  return var;
+}
+
+void SatSolver::heapUp(size_t position) {
+  auto var = heap[position];
+  while (position > 0) {
+    auto parent = (position - 1) / 2;
+    if (activity[heap[parent]] >= activity[var]) break;
+    heap[position] = heap[parent];
+    heap_position[heap[position]] = position;
+    position = parent;
+  }
+  heap[position] = var;
+  heap_position[var] = position;
+}
+
+void SatSolver::heapDown(size_t position) {
+  auto var = heap[position];
+  while (2 * position + 1 < heap.size()) {
+    auto child = 2 * position + 1;
+    if (child + 1 < heap.size() &&
+        activity[heap[child + 1]] > activity[heap[child]]) {
+      child++;
+    }
+    if (activity[heap[child]] <= activity[var]) break;
+    heap[position] = heap[child];
+    heap_position[heap[position]] = position;
+    position = child;
+  }
+  heap[position] = var;
+  heap_position[var] = position;
+}
+
+}  // namespace ClassProject
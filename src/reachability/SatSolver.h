@@ -0,0 +1,112 @@
+// Incremental CDCL SAT solver for bounded model checking
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ClassProject {
+
+/**
+ * Literal of a SatSolver variable: 2 * var for the variable, 2 * var + 1
+ * for its negation
+ */
+typedef uint32_t Literal;
+
+inline Literal positive(uint32_t var) { return var << 1; }
+inline Literal negative(uint32_t var) { return (var << 1) | 1; }
+inline Literal negate(Literal lit) { return lit ^ 1; }
+inline uint32_t variableOf(Literal lit) { return lit >> 1; }
+
+/**
+ * Conflict driven clause learning with two watched literals, first UIP
+ * learning, VSIDS decisions, phase saving and geometric restarts. Clauses
+ * can be added between calls to solve, and each call takes assumptions
+ * that only hold for that call, so learnt clauses are kept across calls.
+ */
+class SatSolver {
+ public:
+  uint32_t newVar();
+
+  inline size_t varCount() const { return assigns.size(); }
+
+  /**
+   * @brief Add a clause, satisfied if any of its literals is true
+   *
+   * An empty clause makes every later call to solve fail.
+   */
+  void addClause(std::vector<Literal> clause);
+
+  /**
+   * @brief Search for an assignment satisfying every clause
+   * @param assumptions Literals that must be true for this call only
+   * @return bool True if satisfiable, the model is then read with value
+   */
+  bool solve(const std::vector<Literal> &assumptions = {});
+
+  /**
+   * @brief Value of a literal in the last model
+   */
+  bool value(Literal lit) const {
+    return model[variableOf(lit)] != (lit & 1);
+  }
+
+ private:
+  static constexpr uint32_t NO_REASON = UINT32_MAX;
+  static constexpr int8_t UNASSIGNED = -1;
+
+  /// 1 if the literal is true, 0 if false, UNASSIGNED otherwise
+  int8_t valueOf(Literal lit) const {
+    auto assign = assigns[variableOf(lit)];
+    return assign == UNASSIGNED ? UNASSIGNED : assign ^ (lit & 1);
+  }
+
+  uint32_t decisionLevel() const { return trail_limits.size(); }
+
+  void enqueue(Literal lit, uint32_t reason);
+
+  /**
+   * @brief Unit propagation over the watched literals
+   * @return uint32_t Index of a falsified clause, NO_REASON if none
+   */
+  uint32_t propagate();
+
+  /**
+   * @brief Derive the first UIP clause of a conflict
+   * @return uint32_t Level to backtrack to, learnt[0] is asserting there
+   */
+  uint32_t analyze(uint32_t conflict, std::vector<Literal> &learnt);
+
+  void backtrack(uint32_t level);
+  uint32_t attach(std::vector<Literal> clause);
+
+  void bumpActivity(uint32_t var);
+  void heapInsert(uint32_t var);
+  uint32_t heapPop();
+  void heapUp(size_t position);
+  void heapDown(size_t position);
+
+  bool ok = true;
+  std::vector<std::vector<Literal>> clauses;
+  /// watches[lit] holds the clauses watching lit, visited when lit is false
+  std::vector<std::vector<uint32_t>> watches;
+
+  std::vector<int8_t> assigns;
+  std::vector<bool> polarity;
+  std::vector<uint32_t> levels;
+  std::vector<uint32_t> reasons;
+  std::vector<Literal> trail;
+  std::vector<size_t> trail_limits;
+  size_t propagated = 0;
+
+  std::vector<double> activity;
+  double activity_increment = 1;
+  /// Binary max-heap of variables by activity, heap_position -1 if absent
+  std::vector<uint32_t> heap;
+  std::vector<int64_t> heap_position;
+
+  std::vector<bool> seen;
+  std::vector<bool> model;
+};
+
+}  // namespace ClassProject
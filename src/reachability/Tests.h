@@ -3,6 +3,11 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+
+#include "../bench/BenchTokenizer.hpp"
+#include "../bench/SequentialBench.hpp"
 #include "Reachability.h"
 
 using namespace ClassProject;
@@ -349,4 +354,599 @@ TEST(Group06_Test, threeStateTwoInputDistanceExample) { /* NOLINT */
   ASSERT_EQ(threestateDistance->stateDistance({true, true, true}), 3);     //! H
 }
 
+TEST_F(ReachabilityTest3States, RingsAreCached) {
+  dynamic_cast<ClassProject::Reachability &>(*fsm).setExploration(
+      ClassProject::Exploration::Symbolic);
+  auto s0 = stateVars.at(0);
+  auto s1 = stateVars.at(1);
+  auto s2 = stateVars.at(2);
+
+  // 3 bit counter
+  transitionFunctions.push_back(fsm->neg(s0));
+  transitionFunctions.push_back(fsm->ite(s0, fsm->neg(s1), s1));
+  transitionFunctions.push_back(
+      fsm->ite(fsm->and2(s1, s0), fsm->neg(s2), s2));
+  fsm->setTransitionFunctions(transitionFunctions);
+  fsm->setInitState({false, false, false});
+
+  ASSERT_EQ(fsm->stateDistance({true, true, true}), 7);
+
+  // Every further query is answered from the cached rings
+  auto size = fsm->uniqueTableSize();
+  ASSERT_EQ(fsm->stateDistance({false, true, true}), 6);
+  ASSERT_EQ(fsm->stateDistance({true, false, false}), 1);
+  ASSERT_TRUE(fsm->isReachable({false, true, false}));
+  ASSERT_EQ(fsm->uniqueTableSize(), size);
+
+  // A new initial state invalidates the rings
+  fsm->setInitState({true, true, true});
+  ASSERT_EQ(fsm->stateDistance({false, false, false}), 1);
+  ASSERT_EQ(fsm->stateDistance({true, true, true}), 0);
+}
+
+TEST(ReachabilityPartitionTest, ResultsIndependentOfThreshold) {
+  ClassProject::Reachability fsm(3);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  auto s0 = fsm.getStates().at(0);
+  auto s1 = fsm.getStates().at(1);
+  auto s2 = fsm.getStates().at(2);
+
+  // 3 bit counter
+  fsm.setTransitionFunctions({fsm.neg(s0), fsm.ite(s0, fsm.neg(s1), s1),
+                              fsm.ite(fsm.and2(s1, s0), fsm.neg(s2), s2)});
+
+  // From one cluster per bit to a monolithic transition relation
+  for (size_t threshold : {size_t(1), size_t(10), SIZE_MAX}) {
+    fsm.setClusterThreshold(threshold);
+    if (threshold == 1) {
+      ASSERT_EQ(fsm.clusterCount(), 3);
+    }
+    if (threshold == SIZE_MAX) {
+      ASSERT_EQ(fsm.clusterCount(), 1);
+    }
+
+    // Drop the cached rings so the traversal runs on the new partition
+    fsm.setInitState({false, false, false});
+    ASSERT_EQ(fsm.stateDistance({true, true, true}), 7);
+    ASSERT_EQ(fsm.stateDistance({false, true, true}), 6);
+    ASSERT_EQ(fsm.stateDistance({true, false, false}), 1);
+  }
+}
+
+TEST(ReachabilityImageEngineTest, FunctionsMatchRelation) {
+  std::vector<std::vector<int>> distances;
+  for (auto engine :
+       {ClassProject::ImageEngine::Relation,
+        ClassProject::ImageEngine::Functions}) {
+    ClassProject::Reachability fsm(3, 1);
+    fsm.setExploration(ClassProject::Exploration::Symbolic);
+    fsm.setImageEngine(engine);
+    auto s0 = fsm.getStates().at(0);
+    auto s1 = fsm.getStates().at(1);
+    auto s2 = fsm.getStates().at(2);
+    auto i0 = fsm.getInputs().at(0);
+
+    // s0 toggles on i0, s1 shifts s0 in, s2 latches s0 AND s1
+    fsm.setTransitionFunctions({fsm.xor2(s0, i0), s0,
+                                fsm.or2(s2, fsm.and2(s0, s1))});
+    if (engine == ClassProject::ImageEngine::Functions) {
+      ASSERT_EQ(fsm.clusterCount(), 0);
+    }
+
+    distances.emplace_back();
+    for (int state = 0; state < 8; state++) {
+      distances.back().push_back(
+          fsm.stateDistance({bool(state & 1), bool(state & 2),
+                             bool(state & 4)}));
+    }
+  }
+
+  ASSERT_EQ(distances[0], distances[1]);
+  ASSERT_EQ(distances[0], std::vector<int>({0, 1, 2, 2, 4, 4, 3, 3}));
+}
+
+TEST(ReachabilitySearchModeTest, AllModesAgree) {
+  for (auto mode : {ClassProject::SearchMode::Forward,
+                    ClassProject::SearchMode::Backward,
+                    ClassProject::SearchMode::Bidirectional}) {
+    ClassProject::Reachability fsm(3, 1);
+    fsm.setExploration(ClassProject::Exploration::Symbolic);
+    fsm.setSearchMode(mode);
+    auto s0 = fsm.getStates().at(0);
+    auto s2 = fsm.getStates().at(2);
+    auto i0 = fsm.getInputs().at(0);
+
+    // s2 keeps its initial value, so only states with s2 = 0 are reachable
+    fsm.setTransitionFunctions({fsm.xor2(s0, i0), s0, s2});
+
+    for (int state = 7; state >= 0; state--) {
+      ASSERT_EQ(fsm.isReachable({bool(state & 1), bool(state & 2),
+                                 bool(state & 4)}),
+                state < 4);
+    }
+  }
+}
+
+TEST(ReachabilityBatchTest, MatchesSingleQueries) {
+  ClassProject::Reachability fsm(3, 1);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  auto s0 = fsm.getStates().at(0);
+  auto s2 = fsm.getStates().at(2);
+  auto i0 = fsm.getInputs().at(0);
+  fsm.setTransitionFunctions(
+      {fsm.xor2(s0, i0), s0, fsm.or2(s2, fsm.and2(s0, fsm.neg(i0)))});
+  fsm.setQueryThreads(4);
+
+  // Enough queries to be spread over several threads
+  std::vector<std::vector<bool>> queries;
+  for (int query = 0; query < 512; query++) {
+    queries.push_back({bool(query & 1), bool(query & 2), bool(query & 4)});
+  }
+
+  auto reachable = fsm.areReachable(queries);
+  auto distances = fsm.stateDistances(queries);
+  ASSERT_EQ(reachable.size(), queries.size());
+  ASSERT_EQ(distances.size(), queries.size());
+  for (size_t query = 0; query < queries.size(); query++) {
+    ASSERT_EQ(distances[query], fsm.stateDistance(queries[query]));
+    ASSERT_EQ(reachable[query], fsm.isReachable(queries[query]));
+  }
+
+  EXPECT_THROW(fsm.areReachable({{true, false}}), std::runtime_error);
+}
+
+TEST(ReachabilityTraceTest, ShortestTrace) {
+  ClassProject::Reachability fsm(3, 1);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  auto s0 = fsm.getStates().at(0);
+  auto s2 = fsm.getStates().at(2);
+  auto i0 = fsm.getInputs().at(0);
+  fsm.setTransitionFunctions(
+      {fsm.xor2(s0, i0), s0, fsm.or2(s2, fsm.and2(s0, fsm.neg(i0)))});
+  auto next = [](const std::vector<bool> &s, const std::vector<bool> &i) {
+    return std::vector<bool>{s[0] != i[0], s[0], s[2] || (s[0] && !i[0])};
+  };
+
+  for (int target = 0; target < 8; target++) {
+    std::vector<bool> state = {bool(target & 1), bool(target & 2),
+                               bool(target & 4)};
+    auto distance = fsm.stateDistance(state);
+    auto trace = fsm.traceTo(state);
+    if (distance < 0) {
+      ASSERT_TRUE(trace.states.empty());
+      continue;
+    }
+
+    // Replay the trace on the transition functions
+    ASSERT_EQ(trace.states.size(), distance + 1);
+    ASSERT_EQ(trace.inputs.size(), distance);
+    ASSERT_EQ(trace.states.front(), std::vector<bool>(3, false));
+    ASSERT_EQ(trace.states.back(), state);
+    for (int step = 0; step < distance; step++) {
+      ASSERT_EQ(next(trace.states[step], trace.inputs[step]),
+                trace.states[step + 1]);
+    }
+  }
+}
+
+TEST(ReachabilitySquaringTest, MatchesOnionRings) {
+  std::vector<std::vector<int>> distances;
+  for (auto squaring : {false, true}) {
+    ClassProject::Reachability fsm(4);
+    fsm.setExploration(ClassProject::Exploration::Symbolic);
+    fsm.setIterativeSquaring(squaring);
+    auto s = fsm.getStates();
+
+    // 3 bit counter, s3 keeps its initial value
+    fsm.setTransitionFunctions(
+        {fsm.neg(s[0]), fsm.xor2(s[1], s[0]),
+         fsm.xor2(s[2], fsm.and2(s[1], s[0])), s[3]});
+
+    distances.emplace_back();
+    for (int state = 0; state < 16; state++) {
+      std::vector<bool> stateVector = {bool(state & 1), bool(state & 2),
+                                       bool(state & 4), bool(state & 8)};
+      distances.back().push_back(fsm.stateDistance(stateVector));
+      ASSERT_EQ(fsm.isReachable(stateVector), state < 8);
+    }
+  }
+
+  ASSERT_EQ(distances[0], distances[1]);
+  ASSERT_EQ(distances[1][7], 7);
+}
+
+TEST(ReachabilityBenchTest, LoadsSequentialCircuit) {
+  auto circuit =
+      LoadSequentialBench(std::string(BENCHMARK_DIR) + "/iscas89/s27.bench");
+  auto &fsm = *circuit.fsm;
+
+  ASSERT_EQ(circuit.state_labels, std::vector<std::string>({"G5", "G6", "G7"}));
+  ASSERT_EQ(circuit.input_labels,
+            std::vector<std::string>({"G0", "G1", "G2", "G3"}));
+  ASSERT_EQ(fsm.getStates().size(), 3);
+  ASSERT_EQ(fsm.getInputs().size(), 4);
+
+  // Distances from an explicit simulation of the netlist
+  std::vector<int> expected = {0, 1, 1, -1, 1, 1, 2, -1};
+  for (int state = 0; state < 8; state++) {
+    ASSERT_EQ(fsm.stateDistance({bool(state & 1), bool(state & 2),
+                                 bool(state & 4)}),
+              expected[state]);
+  }
+}
+
+TEST(ReachabilityInvariantTest, StopsAtFirstViolation) {
+  ClassProject::Reachability fsm(3, 1);
+  auto s = fsm.getStates();
+
+  // 3 bit counter
+  fsm.setTransitionFunctions({fsm.neg(s[0]), fsm.xor2(s[1], s[0]),
+                              fsm.xor2(s[2], fsm.and2(s[1], s[0]))});
+
+  // The counter wraps around, so every state is reached within 7 steps
+  auto holds = fsm.checkInvariant(fsm.True());
+  ASSERT_TRUE(holds.holds);
+  ASSERT_EQ(holds.depth, 7);
+
+  // s1 AND s2 first holds for 6 = 0b110
+  auto violated = fsm.checkInvariant(fsm.nand2(s[1], s[2]), true);
+  ASSERT_FALSE(violated.holds);
+  ASSERT_EQ(violated.depth, 6);
+  ASSERT_EQ(violated.witness.states.size(), 7);
+  ASSERT_EQ(violated.witness.states.back(),
+            std::vector<bool>({false, true, true}));
+
+  EXPECT_THROW(fsm.checkInvariant(fsm.getInputs()[0]), std::runtime_error);
+}
+
+TEST(ReachabilityIncrementalTest, RebuildsOnlyChangedBits) {
+  ClassProject::Reachability fsm(3);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  auto s = fsm.getStates();
+  fsm.setClusterThreshold(1);
+
+  // 3 bit counter
+  std::vector<BDD_ID> counter = {fsm.neg(s[0]), fsm.xor2(s[1], s[0]),
+                                 fsm.xor2(s[2], fsm.and2(s[1], s[0]))};
+  fsm.setTransitionFunctions(counter);
+  ASSERT_EQ(fsm.stateDistance({true, true, true}), 7);
+
+  // Setting the same functions again keeps every cached result
+  auto size = fsm.uniqueTableSize();
+  fsm.setTransitionFunctions(counter);
+  ASSERT_EQ(fsm.stateDistance({false, true, true}), 6);
+  ASSERT_EQ(fsm.uniqueTableSize(), size);
+
+  // Holding s2 changes a single cluster and the results
+  auto holding = counter;
+  holding[2] = s[2];
+  fsm.setTransitionFunctions(holding);
+  ASSERT_EQ(fsm.clusterCount(), 3);
+  ASSERT_EQ(fsm.stateDistance({true, true, true}), -1);
+  ASSERT_EQ(fsm.stateDistance({true, true, false}), 3);
+
+  fsm.setTransitionFunctions(counter);
+  ASSERT_EQ(fsm.stateDistance({true, true, true}), 7);
+}
+
+TEST(ReachabilityCountTest, CountsAndEnumeratesStates) {
+  ClassProject::Reachability fsm(4);
+  auto s = fsm.getStates();
+
+  // 3 bit counter, s3 keeps its initial value
+  fsm.setTransitionFunctions({fsm.neg(s[0]), fsm.xor2(s[1], s[0]),
+                              fsm.xor2(s[2], fsm.and2(s[1], s[0])), s[3]});
+  ASSERT_EQ(fsm.reachableStateCount(), 8);
+
+  // The cubes are disjoint and cover exactly the reachable states
+  auto enumerator = fsm.enumerateReachableStates();
+  boost::multiprecision::cpp_int covered = 0;
+  while (!enumerator.done()) {
+    auto page = enumerator.nextPage(1);
+    ASSERT_LE(page.size(), 1);
+    for (auto &cube : page) {
+      ASSERT_EQ(cube[3], ClassProject::CubeValue::False);
+      int free = std::count(cube.begin(), cube.end(),
+                            ClassProject::CubeValue::DontCare);
+      covered += 1 << free;
+    }
+  }
+  ASSERT_EQ(covered, 8);
+
+  // Counts beyond 64 bits stay exact
+  ClassProject::Reachability wide(70, 70);
+  std::vector<BDD_ID> loaded(wide.getInputs().begin(),
+                             wide.getInputs().end());
+  wide.setTransitionFunctions(loaded);
+  ASSERT_EQ(wide.reachableStateCount(),
+            boost::multiprecision::cpp_int(1) << 70);
+}
+
+TEST(ReachabilityInitStatesTest, ExploresAllInitialStates) {
+  ClassProject::Reachability fsm(3, 1);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  auto s = fsm.getStates();
+
+  // 3 bit counter
+  fsm.setTransitionFunctions({fsm.neg(s[0]), fsm.xor2(s[1], s[0]),
+                              fsm.xor2(s[2], fsm.and2(s[1], s[0]))});
+
+  // Starting from 0 and 4, no state is more than 3 steps away
+  fsm.setInitStates(fsm.nor2(s[0], s[1]));
+  std::vector<int> expected = {0, 1, 2, 3, 0, 1, 2, 3};
+  for (int state = 0; state < 8; state++) {
+    ASSERT_EQ(fsm.stateDistance({bool(state & 1), bool(state & 2),
+                                 bool(state & 4)}),
+              expected[state]);
+  }
+  ASSERT_EQ(fsm.reachableStateCount(), 8);
+
+  EXPECT_THROW(fsm.setInitStates(fsm.getInputs()[0]), std::runtime_error);
+  EXPECT_THROW(fsm.setInitStates(fsm.uniqueTableSize()), std::runtime_error);
+}
+
+TEST(ReachabilityOrderTest, PlacesInputs) {
+  auto fsm = [](const ClassProject::OrderingPolicy &policy) {
+    return std::make_unique<ClassProject::Reachability>(2, 2, policy);
+  };
+
+  auto first = fsm({ClassProject::VariableOrder::InputsFirst, {}});
+  ASSERT_LT(first->getInputs()[1], first->getStates()[0]);
+
+  // i1 before s0, i0 between both state bits
+  auto custom = fsm({ClassProject::VariableOrder::Custom, {1, 0}});
+  auto s = custom->getStates();
+  auto i = custom->getInputs();
+  ASSERT_LT(i[1], s[0]);
+  ASSERT_LT(s[0], i[0]);
+  ASSERT_LT(i[0], s[1]);
+
+  // Results do not depend on the order
+  custom->setExploration(ClassProject::Exploration::Symbolic);
+  custom->setTransitionFunctions(
+      {custom->and2(i[0], custom->neg(s[0])), custom->or2(s[0], i[1])});
+  ASSERT_EQ(custom->stateDistance({true, false}), 1);
+  ASSERT_EQ(custom->stateDistance({false, true}), 1);
+  ASSERT_EQ(custom->stateDistance({true, true}), 1);
+
+  EXPECT_THROW(fsm({ClassProject::VariableOrder::Custom, {0}}),
+               std::runtime_error);
+  EXPECT_THROW(fsm({ClassProject::VariableOrder::Custom, {0, 3}}),
+               std::runtime_error);
+}
+
+TEST(ReachabilityApproximationTest, RejectsUnreachableStates) {
+  ClassProject::Reachability fsm(3);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  auto s = fsm.getStates();
+
+  // s0 and s1 swap, s2 stays false
+  fsm.setTransitionFunctions({s[1], s[0], s[2]});
+  fsm.setInitState({true, false, false});
+  fsm.setApproximation(1, 0);
+
+  // Independent bits lose the correlation of s0 and s1
+  ASSERT_EQ(fsm.overApproximation(), fsm.neg(s[2]));
+  ASSERT_FALSE(fsm.isReachable({false, false, true}));
+  ASSERT_FALSE(fsm.isReachable({true, true, false}));
+  ASSERT_TRUE(fsm.isReachable({false, true, false}));
+
+  // A single block is exact
+  fsm.setApproximation(3, 0);
+  ASSERT_EQ(fsm.overApproximation(), fsm.reachableStates());
+
+  EXPECT_THROW(fsm.setApproximation(2, 2), std::runtime_error);
+}
+
+TEST(ReachabilityExplicitTest, MatchesSymbolicSearch) {
+  std::vector<std::vector<int>> distances;
+  for (auto mode : {ClassProject::Exploration::Symbolic,
+                    ClassProject::Exploration::Explicit,
+                    ClassProject::Exploration::Automatic}) {
+    ClassProject::Reachability fsm(7, 2);
+    fsm.setExploration(mode);
+    fsm.setQueryThreads(4);
+    auto s = fsm.getStates();
+    auto i = fsm.getInputs();
+
+    // Shift register fed by s6 and the inputs, s0 toggles when i0 is set
+    std::vector<ClassProject::BDD_ID> functions = {fsm.xor2(s[0], i[0])};
+    functions.push_back(fsm.ite(i[1], s[0], s[6]));
+    for (size_t k = 2; k < 7; k++) functions.push_back(s[k - 1]);
+    fsm.setTransitionFunctions(functions);
+    fsm.setInitStates(fsm.and2(fsm.neg(s[1]), fsm.neg(s[2])));
+
+    distances.emplace_back();
+    for (int state = 0; state < 128; state++) {
+      std::vector<bool> stateVector;
+      for (int k = 0; k < 7; k++) stateVector.push_back(state >> k & 1);
+      distances.back().push_back(fsm.stateDistance(stateVector));
+      ASSERT_EQ(fsm.isReachable(stateVector), distances.back().back() >= 0);
+    }
+  }
+  ASSERT_EQ(distances[0], distances[1]);
+  ASSERT_EQ(distances[0], distances[2]);
+
+  ClassProject::Reachability wide(29);
+  EXPECT_THROW(wide.setExploration(ClassProject::Exploration::Explicit),
+               std::runtime_error);
+}
+
+TEST(ReachabilityBoundedTest, UnrollsIntoSat) {
+  ClassProject::Reachability fsm(4, 1);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  auto s = fsm.getStates();
+  auto enable = fsm.getInputs().at(0);
+
+  // 4 bit counter counting while enabled
+  auto carry = enable;
+  std::vector<ClassProject::BDD_ID> functions;
+  for (auto &bit : s) {
+    functions.push_back(fsm.xor2(bit, carry));
+    carry = fsm.and2(bit, carry);
+  }
+  fsm.setTransitionFunctions(functions);
+  auto state = [](int value) {
+    return std::vector<bool>{bool(value & 1), bool(value & 2),
+                             bool(value & 4), bool(value & 8)};
+  };
+
+  // Out of nodes: states within the bound are answered by the SAT solver
+  fsm.setResourceLimits({fsm.uniqueTableSize()});
+  ASSERT_EQ(fsm.stateDistance(state(3)), 3);
+  ASSERT_TRUE(fsm.isReachable(state(7)));
+  fsm.setBound(5);
+  EXPECT_THROW(fsm.stateDistance(state(15)), ClassProject::ResourceExhausted);
+  fsm.setBound(0);
+  EXPECT_THROW(fsm.stateDistance(state(3)), ClassProject::ResourceExhausted);
+  fsm.setResourceLimits({});
+
+  fsm.setExploration(ClassProject::Exploration::Bounded);
+  fsm.setBound(15);
+  for (int value = 0; value < 16; value++) {
+    ASSERT_EQ(fsm.stateDistance(state(value)), value);
+  }
+  // 11 steps away: not found within the bound, but not unreachable either
+  fsm.setBound(10);
+  EXPECT_THROW(fsm.isReachable(state(11)), ClassProject::BoundReached);
+  EXPECT_THROW(fsm.stateDistance(state(11)), ClassProject::BoundReached);
+
+  // A bound covering all states also proves unreachability when falling back
+  ClassProject::Reachability toggle(2);
+  toggle.setExploration(ClassProject::Exploration::Symbolic);
+  auto t = toggle.getStates();
+  toggle.setTransitionFunctions({toggle.neg(t[0]), t[1]});
+  toggle.setResourceLimits({toggle.uniqueTableSize()});
+  toggle.setBound(2);
+  EXPECT_THROW(toggle.stateDistance({true, true}),
+               ClassProject::ResourceExhausted);
+  toggle.setBound(3);
+  EXPECT_EQ(toggle.stateDistance({true, true}), -1);
+  EXPECT_FALSE(toggle.isReachable({false, true}));
+  EXPECT_EQ(toggle.stateDistance({true, false}), 1);
+}
+
+TEST(ReachabilitySharedManagerTest, SharesNodes) {
+  ClassProject::Manager manager;
+  auto a = manager.createVar("a");
+
+  // Two variants of a 2 bit counter in one manager
+  ClassProject::Reachability up(manager, 2, 1), toggle(manager, 2);
+  auto u = up.getStates();
+  auto t = toggle.getStates();
+  auto enable = up.getInputs().at(0);
+  ASSERT_LT(a, u[0]);
+  ASSERT_LT(enable, t[0]);
+
+  up.setTransitionFunctions({manager.xor2(u[0], enable),
+                             manager.xor2(u[1], manager.and2(u[0], enable))});
+  toggle.setTransitionFunctions({manager.neg(t[0]), t[1]});
+  ASSERT_EQ(up.uniqueTableSize(), toggle.uniqueTableSize());
+
+  // Functions built by either of them are the same nodes
+  ASSERT_EQ(toggle.and2(u[0], enable), up.and2(enable, u[0]));
+  ASSERT_EQ(manager.uniqueTableSize(), up.uniqueTableSize());
+
+  ASSERT_EQ(up.stateDistance({true, true}), 3);
+  ASSERT_EQ(toggle.stateDistance({true, false}), 1);
+  ASSERT_FALSE(toggle.isReachable({false, true}));
+}
+
+TEST(ReachabilityTelemetryTest, RecordsIterations) {
+  ClassProject::Reachability fsm(3);
+  fsm.setExploration(ClassProject::Exploration::Symbolic);
+  fsm.recordTelemetry();
+  auto s = fsm.getStates();
+
+  // 3 bit counter
+  fsm.setTransitionFunctions({fsm.neg(s[0]), fsm.xor2(s[1], s[0]),
+                              fsm.xor2(s[2], fsm.and2(s[1], s[0]))});
+  ASSERT_EQ(fsm.stateDistance({true, true, true}), 7);
+  fsm.reachableStates();
+
+  // One iteration per ring and the one finding the fixpoint
+  const auto &iterations = fsm.telemetry().iterations;
+  ASSERT_EQ(iterations.size(), 9);
+  for (size_t k = 0; k < iterations.size(); k++) {
+    ASSERT_EQ(iterations[k].iteration, k);
+    ASSERT_EQ(iterations[k].reached_states, std::min<size_t>(k + 1, 8));
+    ASSERT_LE(iterations[k].computed_hits, iterations[k].computed_lookups);
+  }
+  ASSERT_EQ(iterations.back().frontier_nodes, 1);
+  ASSERT_GT(iterations[3].computed_lookups, 0);
+
+  auto csv = fsm.telemetry().toCsv();
+  ASSERT_EQ(std::count(csv.begin(), csv.end(), '\n'), 10);
+  ASSERT_NE(fsm.telemetry().toJson().find("\"reached_states\": 8"),
+            std::string::npos);
+
+  // Statistics were off before recording started
+  ASSERT_TRUE(fsm.statsEnabled());
+  fsm.recordTelemetry(false);
+  ASSERT_FALSE(fsm.statsEnabled());
+}
+
+struct BenchTokenizerTest : testing::Test {
+  std::string path = ::testing::TempDir() + "tokenizer.bench";
+
+  void TearDown() override { std::remove(path.c_str()); }
+};
+
+TEST_F(BenchTokenizerTest, TokenizesStatements) {
+  std::ofstream(path) << "# comment\r\nINPUT(a)\r\n\n  OUTPUT( x )  # out\n"
+                         "x = NAND(a , b.1)\nb.1 = DFF(x)";
+
+  BenchTokenizer tokenizer(path);
+  bench_format::bench_record_type record;
+  ASSERT_TRUE(tokenizer.next(record));
+  ASSERT_EQ(record.gate_type, GateType::Input);
+  ASSERT_EQ(record.label, "a");
+  ASSERT_EQ(record.line, 2);
+  ASSERT_TRUE(tokenizer.next(record));
+  ASSERT_EQ(record.gate_type, GateType::Output);
+  ASSERT_EQ(record.label, "x");
+  ASSERT_TRUE(tokenizer.next(record));
+  ASSERT_EQ(record.label, "x");
+  ASSERT_EQ(record.gate_type, GateType::Nand);
+  ASSERT_EQ(record.inputs, std::vector<std::string_view>({"a", "b.1"}));
+  ASSERT_TRUE(tokenizer.next(record));
+  ASSERT_EQ(record.gate_type, GateType::FlipFlop);
+  ASSERT_EQ(record.line, 6);
+  ASSERT_FALSE(tokenizer.next(record));
+
+  for (auto bad : {"x = AND(a)\n", "x = NOT(a, b)\n", "x = MUX(a, b)\n",
+                   "INPUT(a) b\n", "x AND(a, b)\n"}) {
+    std::ofstream(path) << bad;
+    BenchTokenizer invalid(path);
+    EXPECT_THROW(invalid.next(record), std::runtime_error) << bad;
+  }
+  EXPECT_THROW(BenchTokenizer(path + ".missing"), std::runtime_error);
+}
+
+TEST(ReachabilityBenchTest, InternsLabels) {
+  SymbolTable symbols;
+  auto g10 = symbols.intern("G10");
+  auto g2 = symbols.intern("G2");
+  ASSERT_EQ(g10, 0);
+  ASSERT_EQ(g2, 1);
+  ASSERT_EQ(symbols.intern(std::string("G10")), g10);
+  ASSERT_EQ(symbols.size(), 2);
+  ASSERT_EQ(symbols.name(g2), "G2");
+
+  symbol_t found;
+  ASSERT_TRUE(symbols.find("G2", found));
+  ASSERT_EQ(found, g2);
+  ASSERT_FALSE(symbols.find("G3", found));
+
+  std::vector<symbol_t> labels = {g2, g10};
+  symbols.sortByName(labels);
+  ASSERT_EQ(labels, std::vector<symbol_t>({g10, g2}));
+
+  GateType type;
+  ASSERT_TRUE(ParseGateType("NAND", type));
+  ASSERT_EQ(type, GateType::Nand);
+  ASSERT_EQ(GateTypeName(GateType::FlipFlop), "DFF");
+  ASSERT_FALSE(ParseGateType("MUX", type));
+}
+
 #endif
@@ -0,0 +1,46 @@
+//
+// Replays a journal recorded with Manager::startJournal
+//
+
+#include <spdlog/cfg/env.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#include "Journal.h"
+#include "Manager.h"
+
+using namespace ClassProject;
+
+int main(int argc, char* argv[]) {
+  spdlog::cfg::load_env_levels();
+
+  if (2 > argc) {
+    std::cout << "Usage: " << argv[0] << " <journal> [stats.json]"
+              << std::endl;
+    return -1;
+  }
+
+  JournalReader journal(argv[1]);
+  Manager manager;
+  manager.enableStats(argc > 2);
+
+  auto replay = replayJournal(journal, manager);
+
+  std::cout << "**** Replay ****" << std::endl;
+  std::cout << " Operations: " << replay.operations << std::endl;
+  std::cout << " Runtime: "
+            << std::chrono::duration<double>(replay.elapsed).count()
+            << std::endl;
+  std::cout << " Unique table size: " << manager.uniqueTableSize()
+            << std::endl;
+  std::cout << " Mismatches: " << replay.mismatches << std::endl;
+
+  if (argc > 2) {
+    std::ofstream stats_out(argv[2]);
+    stats_out << manager.stats().toJson();
+  }
+
+  return replay.mismatches ? 1 : 0;
+}
@@ -7,6 +7,8 @@
 #include <fmt/format.h>
 #include <gtest/gtest.h>
 
+#include <cstdio>
+
 #include "../Manager.h"
 
 class ManagerTest : public ::testing::Test {
@@ -276,3 +278,221 @@ TEST_F(ManagerTest, nor2) {
   EXPECT_EQ(a_or_b->low, b->id);
   EXPECT_EQ(a_or_b->top, a->id);
 }
+
+/**
+ * @fn TEST_F(ManagerTest, nodeLimit)
+ * @brief Test that breaching the node limit rolls the operation back
+ */
+TEST_F(ManagerTest, nodeLimit) {
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+  auto c = manager.createVar("C");
+  auto a_or_b = manager.or2(a, b);
+  auto size = manager.uniqueTableSize();
+
+  manager.setResourceLimits({size + 1});
+  EXPECT_THROW(manager.and2(a_or_b, manager.xor2(b, c)),
+               ClassProject::ResourceExhausted);
+  EXPECT_EQ(manager.uniqueTableSize(), size);
+
+  // The aborted operation left no stale computed table entries behind
+  manager.setResourceLimits({});
+  auto f = manager.and2(a_or_b, manager.xor2(b, c));
+  EXPECT_EQ(manager.coFactorTrue(manager.coFactorFalse(f, b), c),
+            manager.and2(a, manager.True()));
+  EXPECT_EQ(manager.coFactorFalse(f, a), manager.and2(b, manager.neg(c)));
+}
+
+/**
+ * @fn TEST_F(ManagerTest, cancellation)
+ * @brief Test that a cancelled token and a passed deadline abort operations
+ */
+TEST_F(ManagerTest, cancellation) {
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+
+  ClassProject::CancellationToken token;
+  manager.setCancellationToken(token);
+  token.cancel();
+  try {
+    manager.and2(a, b);
+    FAIL() << "Expected ResourceExhausted";
+  } catch (const ClassProject::ResourceExhausted& e) {
+    EXPECT_EQ(e.reason(), ClassProject::ResourceExhausted::Reason::Cancelled);
+  }
+  token.reset();
+  EXPECT_EQ(manager.and2(a, b), 4);
+
+  ClassProject::ResourceLimits limits;
+  limits.deadline = ClassProject::ResourceLimits::Clock::now();
+  manager.setResourceLimits(limits);
+  EXPECT_THROW(manager.or2(a, b), ClassProject::ResourceExhausted);
+  EXPECT_EQ(manager.uniqueTableSize(), 5);
+}
+
+/**
+ * @fn TEST_F(ManagerTest, stats)
+ * @brief Test the instrumentation counters
+ */
+TEST_F(ManagerTest, stats) {
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+  manager.and2(a, b);
+  EXPECT_EQ(manager.stats().callsOf(ClassProject::Operation::And2), 0);
+
+  manager.enableStats();
+  manager.or2(a, b);
+  manager.or2(a, b);
+
+  auto stats = manager.stats();
+  EXPECT_EQ(stats.callsOf(ClassProject::Operation::Or2), 2);
+  EXPECT_EQ(stats.computed_lookups, 2);
+  EXPECT_EQ(stats.computed_hits, 1);
+  EXPECT_EQ(stats.computed_misses, 1);
+  EXPECT_EQ(stats.unique_inserts, 1);
+  ASSERT_GT(stats.nodes_per_level.size(), a);
+  EXPECT_EQ(stats.nodes_per_level[a], 1);
+  EXPECT_GE(stats.max_recursion_depth, 2);
+  EXPECT_NE(stats.toJson().find("\"or2\": {\"calls\": 2"), std::string::npos);
+
+  manager.resetStats();
+  EXPECT_EQ(manager.stats().computed_lookups, 0);
+}
+
+/**
+ * @fn TEST_F(ManagerTest, levelHistogram)
+ * @brief Test the per-variable node profile and the growth timeline
+ */
+TEST_F(ManagerTest, levelHistogram) {
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+  manager.recordGrowth();
+  manager.xor2(a, b);
+
+  using Level = std::pair<ClassProject::BDD_ID, size_t>;
+  // A: variable and xor node, B: variable and its negation
+  EXPECT_EQ(manager.levelHistogram(), (std::vector<Level>{{a, 2}, {b, 2}}));
+
+  auto timeline = manager.growthTimeline();
+  ASSERT_EQ(timeline.size(), 1);
+  EXPECT_EQ(timeline[0].op, ClassProject::Operation::Xor2);
+  EXPECT_EQ(timeline[0].unique_table_size, 6);
+
+  // Rolled back nodes are removed from the profile again
+  manager.setResourceLimits({manager.uniqueTableSize() + 1});
+  EXPECT_THROW(manager.and2(manager.createVar("C"), b),
+               ClassProject::ResourceExhausted);
+  EXPECT_EQ(manager.levelHistogram(),
+            (std::vector<Level>{{a, 2}, {b, 2}, {6, 1}}));
+}
+
+/**
+ * @brief ManagerTest recording to a journal in the temporary directory
+ */
+class JournalTest : public ManagerTest {
+ protected:
+  std::string path = ::testing::TempDir() + "journal.bin";
+
+  void TearDown() override {
+    ManagerTest::TearDown();
+    std::remove(path.c_str());
+  }
+};
+
+/**
+ * @fn TEST_F(JournalTest, journal)
+ * @brief Test that outermost operations are journaled with their results
+ */
+TEST_F(JournalTest, journal) {
+  manager.startJournal(path);
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+  auto f = manager.nand2(a, b);
+  manager.stopJournal();
+  manager.neg(f);
+
+  ClassProject::JournalReader journal(path);
+  ClassProject::JournalEntry entry;
+
+  ASSERT_TRUE(journal.next(entry));
+  EXPECT_EQ(entry.op, ClassProject::Operation::CreateVar);
+  EXPECT_EQ(entry.label, "A");
+  EXPECT_EQ(entry.result, a);
+  ASSERT_TRUE(journal.next(entry));
+  EXPECT_EQ(entry.result, b);
+
+  ASSERT_TRUE(journal.next(entry));
+  EXPECT_EQ(entry.op, ClassProject::Operation::Nand2);
+  EXPECT_EQ(entry.operands[0], a);
+  EXPECT_EQ(entry.operands[1], b);
+  EXPECT_EQ(entry.result, f);
+
+  EXPECT_FALSE(journal.next(entry));
+}
+
+/**
+ * @fn TEST_F(JournalTest, replay)
+ * @brief Test that a journal replays, also with operands read from the graph
+ */
+TEST_F(JournalTest, replay) {
+  manager.startJournal(path);
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+  auto c = manager.createVar("C");
+  auto f = manager.or2(manager.and2(a, b), c);
+  // The high child B + C of f is no result of an operation
+  auto node = manager.getNode(f);
+  manager.ite(node->top, node->low, node->high);
+  manager.stopJournal();
+
+  ClassProject::Manager replayed;
+  ClassProject::JournalReader journal(path);
+  auto replay = ClassProject::replayJournal(journal, replayed);
+  EXPECT_EQ(replay.operations, 6);
+  EXPECT_EQ(replay.mismatches, 0);
+  EXPECT_EQ(replayed.uniqueTableSize(), manager.uniqueTableSize());
+}
+
+/**
+ * @fn TEST_F(ManagerTest, naryOperations)
+ * @brief Test andN, orN and xorN against folded binary operations
+ */
+TEST_F(ManagerTest, naryOperations) {
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+  auto c = manager.createVar("C");
+  auto d = manager.createVar("D");
+  auto a_or_b = manager.or2(a, b);
+
+  EXPECT_EQ(manager.andN({a_or_b, c, d, c}),
+            manager.and2(manager.and2(a_or_b, c), d));
+  EXPECT_EQ(manager.orN({manager.and2(a, b), c, d}),
+            manager.or2(manager.or2(manager.and2(a, b), c), d));
+  EXPECT_EQ(manager.xorN({a, b, c, a}), manager.xor2(b, c));
+  EXPECT_EQ(manager.xorN({a, manager.False(), b}), manager.xor2(a, b));
+
+  EXPECT_EQ(manager.andN({a, manager.False(), b}), manager.False());
+  EXPECT_EQ(manager.orN({a, manager.True()}), manager.True());
+  EXPECT_EQ(manager.andN({}), manager.True());
+  EXPECT_EQ(manager.orN({}), manager.False());
+
+  EXPECT_EQ(manager.nodeCount(a_or_b), 4);
+}
+
+/**
+ * @fn TEST_F(ManagerTest, sharedNodeTable)
+ * @brief Test that managers attached to one table share their nodes
+ */
+TEST_F(ManagerTest, sharedNodeTable) {
+  auto a = manager.createVar("A");
+  auto b = manager.createVar("B");
+  auto f = manager.and2(a, b);
+
+  ClassProject::Manager attached(manager.nodeTable());
+  EXPECT_EQ(attached.uniqueTableSize(), manager.uniqueTableSize());
+  EXPECT_EQ(attached.and2(b, a), f);
+
+  auto c = attached.createVar("C");
+  EXPECT_EQ(manager.uniqueTableSize(), attached.uniqueTableSize());
+  EXPECT_EQ(manager.or2(f, c), attached.or2(c, f));
+}